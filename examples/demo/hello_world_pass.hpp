@@ -51,5 +51,7 @@ class hello_world_pass_t : public generic_pass_t {
     spdlog::info("[hello_world_pass_t] symbol name: {}, symbol hash: {}",
                  sym->name(), sym->hash());
   }
+
+  std::string_view name() override { return "hello_world_pass_t"; }
 };
 }  // namespace theo::obf
\ No newline at end of file
@@ -32,7 +32,6 @@
 #include <psapi.h>
 
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 
 #include <spdlog/spdlog.h>
@@ -59,13 +58,6 @@ int main(int argc, char* argv[]) {
   if (argc < 2)
     return -1;
 
-  // read in lib file...
-  std::ifstream f(argv[1], std::ios::binary);
-  auto fsize = fs::file_size(fs::path(argv[1]));
-  std::vector<std::uint8_t> fdata;
-  fdata.resize(fsize);
-  f.read((char*)fdata.data(), fsize);
-
   LoadLibraryA("user32.dll");
   LoadLibraryA("win32u.dll");
 
@@ -110,12 +102,12 @@ int main(int argc, char* argv[]) {
   //
   xed_tables_init();
 
-  // order matters, the order in which the pass is added is the order they
-  // will be executed!
+  // the engine runs each pass after the passes that produce what it requires,
+  // passes that dont declare requirements run in the order they are added...
   //
   auto engine = theo::obf::engine_t::get();
 
-  // add the rest of the passes in this order. this order is important.
+  // add the built in passes, they declare their own order...
   //
   engine->add_pass(theo::obf::func_split_pass_t::get());
   engine->add_pass(theo::obf::reloc_transform_pass_t::get());
@@ -130,10 +122,12 @@ int main(int argc, char* argv[]) {
   std::cout << "enter the name of the entry point: ";
   std::cin >> entry_name;
 
-  // create a theo object and pass in the lib, your allocator, copier, and
-  // resolver functions, as well as the entry point symbol name.
+  // create a theo object and pass in the path to the lib, your allocator,
+  // copier, and resolver functions, as well as the entry point symbol name.
+  // the lib file is memory mapped, it is never read into a buffer...
   //
-  theo::theo_t t(fdata, {allocator, copier, resolver}, entry_name.data());
+  theo::theo_t t(fs::path(argv[1]), {allocator, copier, resolver},
+                 entry_name.data());
 
   // call the decompose method to decompose the lib into coff files and extract
   // the symbols that are used. the result of this call will be an optional
@@ -149,6 +143,11 @@ int main(int argc, char* argv[]) {
   spdlog::info("decomposed {} symbols...", res.value());
   auto entry_pnt = t.compose();
   spdlog::info("entry point address: {:X}", entry_pnt);
+
+  // write where decompose and compose spent their time, open it in
+  // chrome://tracing or https://ui.perfetto.dev...
+  //
+  t.stats().write_trace("theo.trace.json");
   spdlog::info("press enter to execute {}", entry_name.c_str());
 
   std::getchar();
@@ -0,0 +1,88 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <decomp/archive_idx.hpp>
+
+namespace theo::decomp {
+/// <summary>
+/// an obj read out of a lib stream.
+/// </summary>
+struct ar_member_t {
+  std::string name;
+  std::vector<std::uint8_t> data;
+};
+
+/// <summary>
+/// reads the objs of a lib file member by member from a stream. the stream
+/// only needs to support sequential reads so a pipe works. only the member
+/// being read is held in memory, linker members are skipped.
+/// </summary>
+class ar_stream_t {
+ public:
+  /// <summary>
+  /// reads and checks the signature of the lib.
+  /// </summary>
+  /// <param name="in">stream positioned at the start of the lib.</param>
+  explicit ar_stream_t(std::istream& in);
+
+  /// <summary>
+  /// true if the stream starts with the signature of a lib.
+  /// </summary>
+  /// <returns>true if the stream can be read.</returns>
+  bool valid() const;
+
+  /// <summary>
+  /// reads the next obj from the stream.
+  /// </summary>
+  /// <returns>the next obj, no value at the end of the stream or if the stream
+  /// is truncated.</returns>
+  std::optional<ar_member_t> next();
+
+ private:
+  /// <summary>
+  /// gets the name of a member from the name field of its header. long names
+  /// are looked up in the long names member.
+  /// </summary>
+  /// <param name="field">the name field of the member header.</param>
+  /// <returns>the name of the member.</returns>
+  std::string member_name(std::string_view field);
+
+  std::istream& m_in;
+  std::string m_long_names;
+  bool m_valid;
+};
+}  // namespace theo::decomp
@@ -0,0 +1,116 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace theo::decomp {
+/// <summary>
+/// the signature at the start of every lib file.
+/// </summary>
+inline constexpr std::string_view ar_magic = "!<arch>\n";
+
+/// <summary>
+/// the size of the header in front of every archive member.
+/// </summary>
+inline constexpr std::size_t ar_hdr_size = 60;
+
+/// <summary>
+/// parses the size of the data of an archive member from its header.
+/// </summary>
+/// <param name="hdr">the member header, ar_hdr_size bytes.</param>
+/// <returns>the size of the member data, no value if the header is
+/// invalid.</returns>
+std::optional<std::size_t> ar_member_size(const std::uint8_t* hdr);
+
+/// <summary>
+/// public symbol index of a lib file, read from the linker members at the start
+/// of the archive. the second (microsoft) linker member is used if there is
+/// one, otherwise the first. this lets objs be loaded only when a symbol they
+/// define is needed instead of loading every obj of the lib up front.
+/// </summary>
+class archive_idx_t {
+ public:
+  /// <summary>
+  /// parses the linker members of a lib file. nothing is copied, the index
+  /// views the names inside of the lib so the bytes must outlive this object.
+  /// </summary>
+  /// <param name="lib">span of bytes containing the lib file.</param>
+  explicit archive_idx_t(std::span<const std::uint8_t> lib);
+
+  /// <summary>
+  /// true if the lib has a linker member and it was parsed.
+  /// </summary>
+  /// <returns>true if the index can be used.</returns>
+  bool valid() const;
+
+  /// <summary>
+  /// gets the members that define a public symbol.
+  /// </summary>
+  /// <param name="sym">name of the symbol.</param>
+  /// <returns>offsets of the headers of the members that define the symbol,
+  /// sorted in archive order.</returns>
+  std::vector<std::uint32_t> members(std::string_view sym) const;
+
+  /// <summary>
+  /// gets the data of a member given the offset of its header.
+  /// </summary>
+  /// <param name="offset">offset of the member header in the lib.</param>
+  /// <returns>view of the data of the member, empty if the header is
+  /// invalid.</returns>
+  std::span<const std::uint8_t> member(std::uint32_t offset) const;
+
+ private:
+  /// <summary>
+  /// parses the first linker member. all values are big endian, the names are
+  /// in the same order as the member offsets.
+  /// </summary>
+  /// <param name="data">data of the linker member.</param>
+  /// <returns>true if the linker member was parsed.</returns>
+  bool parse_first(std::span<const std::uint8_t> data);
+
+  /// <summary>
+  /// parses the second linker member. all values are little endian, every
+  /// name has a one based index into the member offsets.
+  /// </summary>
+  /// <param name="data">data of the linker member.</param>
+  /// <returns>true if the linker member was parsed.</returns>
+  bool parse_second(std::span<const std::uint8_t> data);
+
+  std::span<const std::uint8_t> m_lib;
+  std::unordered_multimap<std::string_view, std::uint32_t> m_syms;
+  bool m_valid;
+};
+}  // namespace theo::decomp
@@ -0,0 +1,137 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define XED_ENCODER
+extern "C" {
+#include <xed-decode.h>
+#include <xed-interface.h>
+}
+
+namespace theo::decomp {
+/// <summary>
+/// singleton pool of decoded instructions. the decoded instruction of a symbol
+/// is stored here instead of in its own heap allocation, symbols refer to it
+/// by index (see decode_ref_t).
+///
+/// acquiring and releasing slots is thread safe. reading a slot is lock free,
+/// the storage of a slot never moves. a released slot is reused by the next
+/// symbol that decodes its instruction, so the pool holds about as many
+/// decoded instructions as the symbols that are alive and were decoded.
+/// </summary>
+class decode_pool_t {
+  explicit decode_pool_t() : m_size(0) {}
+
+ public:
+  /// <summary>
+  /// get the singleton object of this class.
+  /// </summary>
+  /// <returns>the singleton object of this class.</returns>
+  static decode_pool_t* get();
+
+  /// <summary>
+  /// takes a slot for a decoded instruction from the pool.
+  /// </summary>
+  /// <returns>the index of the slot, zero if the pool is full.</returns>
+  std::uint32_t acquire();
+
+  /// <summary>
+  /// gets the decoded instruction stored in a slot.
+  /// </summary>
+  /// <param name="idx">the index returned by acquire.</param>
+  /// <returns>the decoded instruction of the slot.</returns>
+  xed_decoded_inst_t* at(std::uint32_t idx) const;
+
+  /// <summary>
+  /// gives a slot back to the pool. the slot must not be read afterwards.
+  /// </summary>
+  /// <param name="idx">the index returned by acquire.</param>
+  void release(std::uint32_t idx);
+
+  /// <summary>
+  /// gets the number of slots that were not released.
+  /// </summary>
+  /// <returns>the number of slots in use.</returns>
+  std::size_t size();
+
+  static constexpr std::size_t chunk_size = 0x1000;
+
+ private:
+  static constexpr std::size_t max_chunks = 0x10000;
+
+  std::mutex m_mtx;
+  std::array<std::unique_ptr<xed_decoded_inst_t[]>, max_chunks> m_chunks;
+  std::uint32_t m_size;
+  std::vector<std::uint32_t> m_free;
+};
+
+/// <summary>
+/// a slot of decode_pool_t owned by one symbol. it is released when it is
+/// destroyed and moves with the symbol, so symbols stay movable.
+/// </summary>
+class decode_ref_t {
+ public:
+  decode_ref_t() : m_idx(0) {}
+  ~decode_ref_t();
+
+  decode_ref_t(const decode_ref_t&) = delete;
+  decode_ref_t& operator=(const decode_ref_t&) = delete;
+  decode_ref_t(decode_ref_t&& other) noexcept;
+  decode_ref_t& operator=(decode_ref_t&& other) noexcept;
+
+  /// <summary>
+  /// gets the decoded instruction of the slot, taking a slot from the pool if
+  /// there is none yet.
+  /// </summary>
+  /// <returns>the decoded instruction of the slot, null if the pool is
+  /// full.</returns>
+  xed_decoded_inst_t* acquire();
+
+  /// <summary>
+  /// gets the decoded instruction of the slot.
+  /// </summary>
+  /// <returns>the decoded instruction of the slot, null if there is no
+  /// slot.</returns>
+  xed_decoded_inst_t* get() const;
+
+  /// <summary>
+  /// gives the slot back to the pool.
+  /// </summary>
+  void reset();
+
+ private:
+  std::uint32_t m_idx;
+};
+}  // namespace theo::decomp
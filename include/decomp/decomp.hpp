@@ -30,15 +30,28 @@
 
 #pragma once
 #include <spdlog/spdlog.h>
+#include <array>
 #include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <istream>
 #include <linuxpe>
+#include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include <decomp/ar_stream.hpp>
+#include <decomp/archive_idx.hpp>
+#include <decomp/file_map.hpp>
 #include <decomp/routine.hpp>
 #include <recomp/symbol_table.hpp>
+#include <util/hash.hpp>
+#include <util/parallel.hpp>
 
 #include <coff/archive.hpp>
 #include <coff/image.hpp>
@@ -52,7 +65,35 @@ namespace theo::decomp {
 /// meta symbol data. consists of the coff image which contains the coff symbol,
 /// the coff symbol itself, and the size (if any) of the symbol.
 /// </summary>
-using sym_data_t = std::tuple<coff::image_t*, coff::symbol_t*, std::uint32_t>;
+using sym_data_t =
+    std::tuple<const coff::image_t*, const coff::symbol_t*, std::uint32_t>;
+
+/// <summary>
+/// (section index, offset) of every function symbol in a coff image, sorted so
+/// that the function following any symbol can be found with a binary search.
+/// </summary>
+using fn_idx_t = std::vector<std::pair<std::int16_t, std::uint32_t>>;
+
+/// <summary>
+/// the number of shards the symbol lookup table is split into. shards are
+/// filled in parallel when objs are indexed.
+/// </summary>
+inline constexpr std::size_t lookup_shards = 64;
+
+/// <summary>
+/// the indexed symbols of a single coff image. entries are (symbol name hash,
+/// symbol meta data) grouped by lookup shard, the entries of shard n are
+/// syms[bounds[n], bounds[n + 1]). names holds the interned name of every
+/// symbol of the image indexed by symbol index, auxiliary records and skipped
+/// symbols are no_name. hash is the hash of the bytes of the obj.
+/// </summary>
+struct obj_idx_t {
+  const coff::image_t* img;
+  std::uint64_t hash;
+  std::vector<std::pair<std::size_t, sym_data_t>> syms;
+  std::array<std::uint32_t, lookup_shards + 1> bounds;
+  std::vector<name_id_t> names;
+};
 
 /// <summary>
 /// the main decomposition class which is responsible for breaking down lib file
@@ -61,31 +102,55 @@ using sym_data_t = std::tuple<coff::image_t*, coff::symbol_t*, std::uint32_t>;
 class decomp_t {
  public:
   /// <summary>
-  /// the explicit constructor for decomp_t
+  /// the explicit constructor for decomp_t. the lib is borrowed, not copied,
+  /// so the bytes must outlive this object and the symbols it creates.
   /// </summary>
-  /// <param name="lib">vector of bytes containing the lib file.</param>
+  /// <param name="lib">span of bytes containing the lib file.</param>
   /// <param name="syms">symbol table that gets populated and managed by this
   /// class.</param>
-  explicit decomp_t(std::vector<std::uint8_t>& lib,
+  explicit decomp_t(std::span<const std::uint8_t> lib,
                     recomp::symbol_table_t* syms);
 
+  /// <summary>
+  /// explicit constructor for decomp_t which maps the lib file into memory
+  /// read only. coff images and symbol bytes point directly into the mapping,
+  /// unless the obj is not aligned for the coff structures, then it is copied.
+  /// </summary>
+  /// <param name="lib">path to the lib file.</param>
+  /// <param name="syms">symbol table that gets populated and managed by this
+  /// class.</param>
+  explicit decomp_t(const std::filesystem::path& lib,
+                    recomp::symbol_table_t* syms);
+
+  /// <summary>
+  /// explicit constructor for decomp_t which reads the lib from a stream, such
+  /// as a pipe, in a single pass. only the objs that may define used symbols
+  /// are kept in memory. the stream must outlive the call to decompose.
+  /// </summary>
+  /// <param name="lib">stream positioned at the start of the lib.</param>
+  /// <param name="syms">symbol table that gets populated and managed by this
+  /// class.</param>
+  explicit decomp_t(std::istream& lib, recomp::symbol_table_t* syms);
+
   /// <summary>
   /// gets all of the routine objects.
   /// </summary>
   /// <returns>vector of routine objects.</returns>
-  std::vector<routine_t> rtns();
+  const std::vector<routine_t>& rtns();
 
   /// <summary>
-  /// gets a vector of bytes consisting of the lib file.
+  /// gets a view of the bytes of the lib file. empty if the lib is read from a
+  /// stream.
   /// </summary>
-  /// <returns>a vector of bytes consisting of the lib file.</returns>
-  std::vector<std::uint8_t> lib();
+  /// <returns>a view of the bytes of the lib file.</returns>
+  std::span<const std::uint8_t> lib();
 
   /// <summary>
-  /// gets all the obj files as a vector of a vector of bytes.
+  /// gets all the loaded obj files as views into the lib file. if the lib has
+  /// a linker member, only the objs that define used symbols are loaded.
   /// </summary>
-  /// <returns>all the obj files as a vector of a vector of bytes.</returns>
-  std::vector<std::vector<std::uint8_t>> objs();
+  /// <returns>all the loaded obj files as views into the lib file.</returns>
+  const std::vector<std::span<const std::uint8_t>>& objs();
 
   /// <summary>
   /// gets the symbol table.
@@ -94,12 +159,31 @@ class decomp_t {
   recomp::symbol_table_t* syms();
 
   /// <summary>
-  /// gets the section hash table section header --> hash of the section header
-  /// ptr.
+  /// gets the symbol generated for a section. section symbols are only
+  /// generated for sections that contain used data symbols.
+  /// </summary>
+  /// <param name="img">coff image that contains the section.</param>
+  /// <param name="scn">section header of the section.</param>
+  /// <returns>pointer to the section symbol in the symbol table, nullptr if
+  /// no symbol was generated for the section.</returns>
+  symbol_t* scn_sym(const coff::image_t* img,
+                    const coff::section_header_t* scn);
+
+  /// <summary>
+  /// sets the maximum number of threads used for decomposition. defaults to the
+  /// number of hardware threads. one disables threading.
+  /// </summary>
+  /// <param name="threads">the maximum number of threads.</param>
+  void threads(std::uint32_t threads);
+
+  /// <summary>
+  /// sets the maximum number of bytes of objs read from a stream that are held
+  /// back because they do not define a used symbol yet. when the limit is hit
+  /// the oldest held back objs are dropped. objs that define used symbols are
+  /// always kept and do not count towards the limit.
   /// </summary>
-  /// <returns>the section hash table section header --> hash of the section
-  /// header ptr.</returns>
-  std::map<coff::section_header_t*, std::size_t>& scn_hash_tbl();
+  /// <param name="bytes">the maximum number of bytes to hold back.</param>
+  void retain_limit(std::size_t bytes);
 
   /// <summary>
   /// decomposes (extracts) the symbols used. this function determines all used
@@ -110,40 +194,266 @@ class decomp_t {
   /// optional object on failure.</returns>
   std::optional<recomp::symbol_table_t*> decompose(std::string& entry_sym);
 
+  /// <summary>
+  /// decomposes a new version of the lib, redoing only the work for the objs
+  /// that changed. objs are matched by the hash of their bytes. the symbols of
+  /// changed or removed objs are erased from the symbol table, the symbols of
+  /// the new objs that are used are decomposed, and symbols that are no longer
+  /// used are erased. symbols of unchanged objs are left in the table as they
+  /// are, so the result of passes that already ran on them is kept.
+  ///
+  /// decompose must have been called first. the previous lib is kept mapped
+  /// since the symbols of unchanged objs still point into it.
+  /// </summary>
+  /// <param name="lib">span of bytes containing the new lib file. borrowed
+  /// like the lib given to the constructor.</param>
+  /// <param name="entry_sym">the entry point symbol name.</param>
+  /// <returns>returns an optional pointer to the symbol table. no value in the
+  /// optional object on failure.</returns>
+  std::optional<recomp::symbol_table_t*> redecompose(
+      std::span<const std::uint8_t> lib,
+      std::string& entry_sym);
+
+  /// <summary>
+  /// maps a new version of the lib file read only and redecomposes it.
+  /// </summary>
+  /// <param name="lib">path to the new lib file.</param>
+  /// <param name="entry_sym">the entry point symbol name.</param>
+  /// <returns>returns an optional pointer to the symbol table. no value in the
+  /// optional object on failure.</returns>
+  std::optional<recomp::symbol_table_t*> redecompose(
+      const std::filesystem::path& lib,
+      std::string& entry_sym);
+
  private:
   /// <summary>
   /// extracts used symbols from coff files.
   /// </summary>
   /// <param name="entry_sym">the entry point symbol name</param>
   /// <returns>number of symbols used</returns>
-  std::uint32_t ext_used_syms(const std::string&& entry_sym);
+  std::uint32_t ext_used_syms(name_id_t entry_sym);
+
+  /// <summary>
+  /// adds every symbol reachable from newly used symbols to the used symbols.
+  /// the references of each symbol are counted in m_refs.
+  /// </summary>
+  /// <param name="used">symbols that were just added to m_used_syms. the
+  /// symbols reached from them that were not used yet are appended.</param>
+  void mark_used(std::vector<sym_data_t>& used);
+
+  /// <summary>
+  /// removes a symbol from the used symbols and drops the references it makes.
+  /// </summary>
+  /// <param name="data">symbol meta data of the used symbol.</param>
+  /// <param name="dropped">receives the names the symbol referenced.</param>
+  void unuse(sym_data_t data, std::vector<name_id_t>& dropped);
+
+  /// <summary>
+  /// gets the names of the symbols a symbol references through relocations.
+  /// </summary>
+  /// <param name="data">symbol meta data.</param>
+  /// <returns>the interned names of the referenced symbols.</returns>
+  std::vector<name_id_t> sym_refs(sym_data_t data);
 
   /// <summary>
-  /// get symbol meta data by name.
+  /// forgets everything known about a loaded obj. the used symbols of the obj
+  /// are removed from the used symbols.
   /// </summary>
-  /// <param name="name">symbol name</param>
+  /// <param name="img">coff image of the obj.</param>
+  /// <param name="lost">receives the names of the used symbols of the
+  /// obj.</param>
+  /// <param name="dropped">receives the names referenced by the used symbols
+  /// of the obj.</param>
+  void unload_obj(const coff::image_t* img,
+                  std::vector<name_id_t>& lost,
+                  std::vector<name_id_t>& dropped);
+
+  /// <summary>
+  /// generates the symbols for used symbols and the sections that contain
+  /// them, and puts them into the symbol table. the symbols are generated in
+  /// parallel but put into the table in an order that only depends on the
+  /// bytes of the objs.
+  /// </summary>
+  /// <param name="used">symbol meta data of the used symbols.</param>
+  /// <returns>false if a symbol could not be put into the table because
+  /// another symbol has the same hash.</returns>
+  bool decompose_used(const std::vector<sym_data_t>& used);
+
+  /// <summary>
+  /// brings the used symbols and the symbol table up to date with m_lib after
+  /// it was replaced by a new version of the lib.
+  /// </summary>
+  /// <param name="entry_sym">interned entry point symbol name.</param>
+  /// <returns>false if the symbols could not be decomposed, see
+  /// decompose_used.</returns>
+  bool update_objs(name_id_t entry_sym);
+
+  /// <summary>
+  /// gets the relocations of a section sorted by virtual address. the sorted
+  /// relocations are built once per section and cached.
+  /// </summary>
+  /// <param name="img">coff image that contains the section.</param>
+  /// <param name="scn">section header of the section.</param>
+  /// <returns>the relocations of the section sorted by virtual
+  /// address.</returns>
+  std::span<const coff::reloc_t> scn_relocs(const coff::image_t* img,
+                                            const coff::section_header_t* scn);
+
+  /// <summary>
+  /// gets the relocations inside of [offset, offset + size) of a section.
+  /// </summary>
+  /// <param name="img">coff image that contains the section.</param>
+  /// <param name="scn">section header of the section.</param>
+  /// <param name="offset">offset into the section.</param>
+  /// <param name="size">size of the range.</param>
+  /// <returns>the relocations inside of the range sorted by virtual
+  /// address.</returns>
+  std::span<const coff::reloc_t> relocs_in(const coff::image_t* img,
+                                           const coff::section_header_t* scn,
+                                           std::uint32_t offset,
+                                           std::uint32_t size);
+
+  /// <summary>
+  /// get symbol meta data by name. if no loaded obj defines the symbol, the
+  /// objs that define it according to the linker member are loaded first.
+  /// </summary>
+  /// <param name="name">interned symbol name</param>
   /// <returns>optional symbol meta data if it exists.</returns>
-  std::optional<sym_data_t> get_symbol(const std::string_view& name);
+  std::optional<sym_data_t> get_symbol(name_id_t name);
 
   /// <summary>
-  /// the next symbol in the section.
+  /// get symbol meta data by name from the objs that are already loaded.
+  /// </summary>
+  /// <param name="name">interned symbol name</param>
+  /// <returns>optional symbol meta data if it exists.</returns>
+  std::optional<sym_data_t> find_symbol(name_id_t name);
+
+  /// <summary>
+  /// loads the objs that define a symbol according to the linker member and
+  /// that are not loaded yet.
+  /// </summary>
+  /// <param name="name">interned symbol name</param>
+  /// <returns>true if any obj was loaded.</returns>
+  bool load_members(name_id_t name);
+
+  /// <summary>
+  /// reads the objs of the lib from m_stream. an obj is kept if it defines a
+  /// symbol that is wanted, starting with the entry point symbol. the external
+  /// symbols referenced by a kept obj are wanted from then on. other objs are
+  /// held back in case a later obj wants one of their symbols.
+  /// </summary>
+  /// <param name="entry_sym">interned entry point symbol name.</param>
+  /// <returns>false if the stream is not a lib.</returns>
+  bool stream_objs(name_id_t entry_sym);
+
+  /// <summary>
+  /// gets the external symbols an obj defines and the ones it references
+  /// without defining them.
+  /// </summary>
+  /// <param name="img">coff image to scan.</param>
+  /// <param name="defs">receives the defined external symbol names.</param>
+  /// <param name="refs">receives the undefined external symbol names.</param>
+  void scan_externals(const coff::image_t* img,
+                      std::vector<name_id_t>& defs,
+                      std::vector<name_id_t>& refs);
+
+  /// <summary>
+  /// indexes objs and adds their symbols to the lookup table. the objs are
+  /// indexed in parallel. objs that are not aligned for the coff structures
+  /// are copied first, the others are used in place.
+  /// </summary>
+  /// <param name="objs">the objs to load as views into the lib file.</param>
+  void load_objs(const std::vector<std::span<const std::uint8_t>>& objs);
+
+  /// <summary>
+  /// gets the interned name of a symbol of an indexed coff image. names are
+  /// interned once when the image is indexed.
   /// </summary>
   /// <param name="img">coff image that contains the symbol.</param>
+  /// <param name="sym_idx">index of the symbol.</param>
+  /// <returns>the interned name of the symbol.</returns>
+  name_id_t sym_name(const coff::image_t* img, std::uint32_t sym_idx);
+
+  /// <summary>
+  /// generates the symbol for a section. safe to call from multiple threads.
+  /// </summary>
+  /// <param name="img">coff image that contains the section.</param>
+  /// <param name="scn_idx">zero based index of the section.</param>
+  /// <returns>the section symbol.</returns>
+  symbol_t decompose_scn(const coff::image_t* img, std::uint32_t scn_idx);
+
+  /// <summary>
+  /// generates the symbol for a used symbol. safe to call from multiple
+  /// threads once the section symbols of the used symbols are in the symbol
+  /// table.
+  /// </summary>
+  /// <param name="data">symbol meta data of the used symbol.</param>
+  /// <returns>the symbol, no value if the used symbol does not need
+  /// one.</returns>
+  std::optional<symbol_t> decompose_sym(sym_data_t data);
+
+  /// <summary>
+  /// creates the name of the symbol for a section. the format is:
+  ///
+  ///   .section_name#section_index!coff_file_timestamp
+  ///
+  /// </summary>
+  /// <param name="img">coff image that contains the section.</param>
+  /// <param name="scn_idx">zero based index of the section.</param>
+  /// <returns>the interned name of the section symbol.</returns>
+  name_id_t scn_sym_name(const coff::image_t* img, std::uint32_t scn_idx);
+
+  /// <summary>
+  /// indexes every named symbol of a coff image. this only reads the image so
+  /// it is safe to index different images on different threads.
+  /// </summary>
+  /// <param name="img">coff image to index.</param>
+  /// <returns>the symbols of the image grouped by lookup shard.</returns>
+  obj_idx_t index_obj(const coff::image_t* img);
+
+  /// <summary>
+  /// builds the sorted function symbol index of a coff image.
+  /// </summary>
+  /// <param name="img">coff image to index.</param>
+  /// <returns>the sorted function symbol index.</returns>
+  fn_idx_t index_fns(const coff::image_t* img);
+
+  /// <summary>
+  /// the next symbol in the section.
+  /// </summary>
+  /// <param name="fns">function symbol index of the coff image that contains
+  /// the symbol.</param>
   /// <param name="hdr">coff section header of the section that contains the
   /// symbol.</param>
   /// <param name="s">symbol in which to get the next one of.</param>
   /// <returns>offset into the section where the next symbol is at.</returns>
-  std::uint32_t next_sym(coff::image_t* img,
-                         coff::section_header_t* hdr,
-                         coff::symbol_t* s);
+  std::uint32_t next_sym(const fn_idx_t& fns,
+                         const coff::section_header_t* hdr,
+                         const coff::symbol_t* s);
 
-  const std::vector<std::uint8_t> m_lib;
-  std::vector<std::vector<std::uint8_t>> m_objs;
+  std::unique_ptr<file_map_t> m_map;
+  std::vector<std::unique_ptr<file_map_t>> m_old_maps;
+  std::span<const std::uint8_t> m_lib;
+  std::unique_ptr<archive_idx_t> m_ar_idx;
+  std::istream* m_stream;
+  std::deque<std::vector<std::uint8_t>> m_obj_bufs;
+  std::size_t m_retain_limit;
+  std::unordered_set<std::uint32_t> m_loaded_members;
+  std::vector<std::span<const std::uint8_t>> m_objs;
   std::vector<routine_t> m_rtns;
   std::set<sym_data_t> m_used_syms;
-  std::set<coff::image_t*> m_processed_objs;
-  std::map<coff::section_header_t*, std::size_t> m_scn_hash_tbl;
-  std::map<std::size_t, std::vector<sym_data_t>> m_lookup_tbl;
+  std::unordered_map<name_id_t, std::uint32_t> m_refs;
+  std::unordered_map<const coff::image_t*, std::uint64_t> m_obj_hashes;
+  std::unordered_map<const coff::image_t*, std::vector<symbol_t*>> m_scn_syms;
+  std::array<std::unordered_map<std::size_t, std::vector<sym_data_t>>,
+             lookup_shards>
+      m_lookup_tbl;
+  std::unordered_map<const coff::section_header_t*,
+                     std::span<const coff::reloc_t>>
+      m_reloc_tbl;
+  std::vector<std::vector<coff::reloc_t>> m_sorted_relocs;
+  std::unordered_map<const coff::image_t*, std::vector<name_id_t>> m_sym_names;
   recomp::symbol_table_t* m_syms;
+  std::uint32_t m_threads;
 };
 }  // namespace theo::decomp
\ No newline at end of file
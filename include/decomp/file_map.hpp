@@ -0,0 +1,73 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace theo::decomp {
+/// <summary>
+/// read only memory mapping of a file. this is used to map lib files into
+/// memory so that coff images and symbol bytes can point directly into the
+/// mapping instead of being copied out of the archive.
+/// </summary>
+class file_map_t {
+ public:
+  /// <summary>
+  /// maps the file read only. if the mapping fails, data() will be empty.
+  /// </summary>
+  /// <param name="path">path to the file to map.</param>
+  explicit file_map_t(const std::filesystem::path& path);
+
+  /// <summary>
+  /// unmaps the file.
+  /// </summary>
+  ~file_map_t();
+
+  file_map_t(const file_map_t&) = delete;
+  file_map_t& operator=(const file_map_t&) = delete;
+
+  /// <summary>
+  /// gets the mapped bytes of the file.
+  /// </summary>
+  /// <returns>the mapped bytes of the file. empty if mapping failed.</returns>
+  std::span<const std::uint8_t> data() const;
+
+ private:
+  void* m_base;
+  std::size_t m_size;
+#ifdef _WIN32
+  void* m_file;
+  void* m_mapping;
+#endif
+};
+}  // namespace theo::decomp
@@ -0,0 +1,159 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace theo::decomp {
+/// <summary>
+/// id of an interned symbol name. ids are handed out by name_pool_t.
+/// </summary>
+using name_id_t = std::uint32_t;
+
+/// <summary>
+/// a name id that no name is ever given. used for optional names.
+/// </summary>
+inline constexpr name_id_t no_name = ~name_id_t{};
+
+/// <summary>
+/// singleton pool of interned symbol names. every distinct name is stored once
+/// along with its hash, symbols and relocations refer to names by id. the text
+/// of a name is only needed for logging and for resolving external symbols.
+///
+/// hashes are stable 64-bit hashes (see util::hash64) and are unique within the
+/// pool. the hash of a name only depends on the name, unless it collides with
+/// the hash of a name that is already in the pool. the second name then gets a
+/// fallback hash, a seeded hash of the name, so which of the two names keeps
+/// its hash depends on the order they were interned in. nothing is ordered by
+/// hash and table files store names, so this only changes the hash values.
+///
+/// the pool is split into shards picked by the top bits of the hash of a name,
+/// each with its own lock, so threads interning different names rarely wait on
+/// each other. looking up the name or hash of an id is lock free, the storage
+/// of an interned name never moves.
+///
+/// names are never removed, ids are held by symbols, relocations and table
+/// files that outlive the objs they came from. interning a name that is
+/// already in the pool does not grow it, so decomp_t::redecompose only adds
+/// the names that are new in the rebuilt objs: mostly the names of their
+/// private section symbols, which include the timestamp of the obj, and the
+/// names of instructions at offsets that did not exist before. the pool grows
+/// by about the number of symbols in the changed objs per rebuild, see size.
+/// </summary>
+class name_pool_t {
+  explicit name_pool_t() : m_size(0), m_segs{} {}
+  ~name_pool_t();
+
+ public:
+  /// <summary>
+  /// get the singleton object of this class.
+  /// </summary>
+  /// <returns>the singleton object of this class.</returns>
+  static name_pool_t* get();
+
+  /// <summary>
+  /// interns a name.
+  /// </summary>
+  /// <param name="name">the name to intern.</param>
+  /// <returns>the id of the name. the same name always gets the same
+  /// id.</returns>
+  name_id_t intern(std::string_view name);
+
+  /// <summary>
+  /// gets the text of an interned name.
+  /// </summary>
+  /// <param name="id">id of the name.</param>
+  /// <returns>the text of the name. valid for the lifetime of the
+  /// program.</returns>
+  std::string_view name(name_id_t id) const;
+
+  /// <summary>
+  /// gets the hash of an interned name. the hash is computed once when the name
+  /// is interned and no other name in the pool has the same hash.
+  /// </summary>
+  /// <param name="id">id of the name.</param>
+  /// <returns>the hash of the name.</returns>
+  std::uint64_t hash(name_id_t id) const;
+
+  /// <summary>
+  /// gets the number of names in the pool.
+  /// </summary>
+  /// <returns>the number of names interned so far.</returns>
+  std::uint32_t size() const;
+
+ private:
+  /// <summary>
+  /// an interned name and its hash.
+  /// </summary>
+  struct entry_t {
+    std::string name;
+    std::uint64_t hash;
+  };
+
+  /// <summary>
+  /// one shard of the pool. it maps the names and hashes whose hash selects
+  /// this shard to their id.
+  /// </summary>
+  struct shard_t {
+    std::shared_mutex mtx;
+    std::unordered_map<std::string_view, name_id_t> ids;
+    std::unordered_map<std::uint64_t, name_id_t> hashes;
+  };
+
+  static constexpr std::size_t num_shards = 0x40;
+  static constexpr std::size_t seg_base = 0x1000;
+  static constexpr std::size_t max_segs = 20;
+
+  /// <summary>
+  /// gets the entry of an id.
+  /// </summary>
+  /// <param name="id">id of the name.</param>
+  /// <returns>reference to the entry.</returns>
+  entry_t& entry(name_id_t id) const;
+
+  /// <summary>
+  /// hands out a new id and makes sure the storage of its entry exists.
+  /// </summary>
+  /// <returns>the new id.</returns>
+  name_id_t new_id();
+
+  std::array<shard_t, num_shards> m_shards;
+  std::atomic<std::uint32_t> m_size;
+  std::array<std::atomic<entry_t*>, max_segs> m_segs;
+  std::mutex m_segs_mtx;
+};
+}  // namespace theo::decomp
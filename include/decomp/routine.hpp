@@ -30,6 +30,7 @@
 
 #pragma once
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -59,14 +60,21 @@ class routine_t {
   /// <param name="img">the coff image which contains the symbol.</param>
   /// <param name="scn">the section header of the section that contains the
   /// symbol.</param>
-  /// <param name="fn">the data (bytes) of the function.</param>
+  /// <param name="fn">the data (bytes) of the function. the bytes are borrowed
+  /// and must outlive the symbol created by decompose.</param>
+  /// <param name="relocs">the relocations inside of the function sorted by
+  /// virtual address.</param>
+  /// <param name="names">the interned names of the symbols of the coff image
+  /// indexed by symbol index.</param>
   /// <param name="dcmp_type">the type of decomp to do. if this is
   /// sym_type_t::function then this class wont split the function up into
   /// individual instructions.</param>
-  explicit routine_t(coff::symbol_t* sym,
-                     coff::image_t* img,
-                     coff::section_header_t* scn,
-                     std::vector<std::uint8_t>& fn);
+  explicit routine_t(const coff::symbol_t* sym,
+                     const coff::image_t* img,
+                     const coff::section_header_t* scn,
+                     std::span<const std::uint8_t> fn,
+                     std::span<const coff::reloc_t> relocs,
+                     std::span<const name_id_t> names);
 
   /// <summary>
   /// decompose the function into symbol(s).
@@ -79,18 +87,20 @@ class routine_t {
   /// </summary>
   /// <returns>the section header of the section in which the symbol is located
   /// in.</returns>
-  coff::section_header_t* scn();
+  const coff::section_header_t* scn();
 
   /// <summary>
   /// gets the function bytes.
   /// </summary>
   /// <returns>the function bytes.</returns>
-  std::vector<std::uint8_t> data();
+  std::span<const std::uint8_t> data();
 
  private:
-  coff::symbol_t* m_sym;
-  std::vector<std::uint8_t> m_data;
-  coff::image_t* m_img;
-  coff::section_header_t* m_scn;
+  const coff::symbol_t* m_sym;
+  std::span<const std::uint8_t> m_data;
+  std::span<const coff::reloc_t> m_relocs;
+  std::span<const name_id_t> m_names;
+  const coff::image_t* m_img;
+  const coff::section_header_t* m_scn;
 };
 }  // namespace theo::decomp
\ No newline at end of file
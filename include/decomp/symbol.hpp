@@ -31,11 +31,29 @@
 #pragma once
 #include <coff/image.hpp>
 #include <cstdint>
+#include <decomp/decode_pool.hpp>
+#include <decomp/name_pool.hpp>
+#include <memory>
 #include <recomp/reloc.hpp>
+#include <span>
 #include <string>
+#include <string_view>
+#include <util/small_vector.hpp>
 #include <vector>
 
 namespace theo::decomp {
+/// <summary>
+/// the bytes of a symbol. x86 instructions are at most 15 bytes, so the bytes
+/// of instruction symbols are stored inline without a heap allocation.
+/// </summary>
+using bytes_t = util::small_vector<std::uint8_t, 16>;
+
+/// <summary>
+/// the relocations of a symbol. an instruction has at most a relocation of its
+/// own and one to the next instruction, so those are stored inline.
+/// </summary>
+using relocs_t = util::small_vector<recomp::reloc_t, 2>;
+
 /// <summary>
 /// meta symbol type. this is an abstraction upon the coff symbol storage/class
 /// type.
@@ -62,7 +80,7 @@ class symbol_t {
   /// the explicit constructor of this symbol.
   /// </summary>
   /// <param name="img">the image in which the symbol is located in.</param>
-  /// <param name="name">the name of the symbol.</param>
+  /// <param name="name">the interned name of the symbol.</param>
   /// <param name="offset">offset into the section where this symbol is
   /// located.</param>
   /// <param name="data">the data of the symbol. there can be
@@ -73,20 +91,61 @@ class symbol_t {
   /// <param name="relocs">a vector of relocations this symbol has (if
   /// any).</param>
   /// <param name="dcmp_type">the type of symbol</param>
-  explicit symbol_t(coff::image_t* img,
-                    std::string name,
+  explicit symbol_t(const coff::image_t* img,
+                    name_id_t name,
                     std::uintptr_t offset,
-                    std::vector<std::uint8_t> data,
-                    coff::section_header_t* scn = {},
-                    coff::symbol_t* sym = {},
-                    std::vector<recomp::reloc_t> relocs = {},
+                    bytes_t data,
+                    const coff::section_header_t* scn = {},
+                    const coff::symbol_t* sym = {},
+                    relocs_t relocs = {},
                     sym_type_t dcmp_type = {});
 
+  /// <summary>
+  /// constructor for a symbol whose data is borrowed from memory that outlives
+  /// the symbol (such as a memory mapped lib file). the data is only copied
+  /// if it is modified through symbol_t::data.
+  /// </summary>
+  /// <param name="img">the image in which the symbol is located in.</param>
+  /// <param name="name">the interned name of the symbol.</param>
+  /// <param name="offset">offset into the section where this symbol is
+  /// located.</param>
+  /// <param name="view">view of the data of the symbol.</param>
+  /// <param name="scn">the section header describing the
+  /// section which contains the symbol.</param>
+  /// <param name="sym">the coff symbol itself.</param>
+  /// <param name="relocs">a vector of relocations this symbol has (if
+  /// any).</param>
+  /// <param name="dcmp_type">the type of symbol</param>
+  explicit symbol_t(const coff::image_t* img,
+                    name_id_t name,
+                    std::uintptr_t offset,
+                    std::span<const std::uint8_t> view,
+                    const coff::section_header_t* scn,
+                    const coff::symbol_t* sym,
+                    relocs_t relocs,
+                    sym_type_t dcmp_type);
+
+  /// <summary>
+  /// symbols own their bytes and relocations, they are moved through decomp,
+  /// the symbol table and the passes and never copied. copying is disabled so
+  /// that an accidental copy does not compile.
+  /// </summary>
+  symbol_t(const symbol_t&) = delete;
+  symbol_t& operator=(const symbol_t&) = delete;
+  symbol_t(symbol_t&&) noexcept = default;
+  symbol_t& operator=(symbol_t&&) noexcept = default;
+
   /// <summary>
   /// gets the name of the symbol.
   /// </summary>
   /// <returns>the name of the symbol.</returns>
-  std::string name() const;
+  std::string_view name() const;
+
+  /// <summary>
+  /// gets the id of the interned name of the symbol.
+  /// </summary>
+  /// <returns>the id of the interned name of the symbol.</returns>
+  name_id_t name_id() const;
 
   /// <summary>
   /// gets the offset into the section where the symbol is located.
@@ -112,26 +171,90 @@ class symbol_t {
   /// </summary>
   /// <returns>the section header of the section in which the symbol is
   /// contained.</returns>
-  coff::section_header_t* scn() const;
+  const coff::section_header_t* scn() const;
+
+  /// <summary>
+  /// gets the characteristics of the section in which the symbol is
+  /// contained. these are copied out of the section header when the symbol is
+  /// created so they are known even when the coff image is not loaded.
+  /// </summary>
+  /// <returns>the characteristics of the section.</returns>
+  coff::section_characteristics_t scn_chars() const;
+
+  /// <summary>
+  /// sets the characteristics of the section in which the symbol is contained.
+  /// </summary>
+  /// <param name="chars">characteristics of the section.</param>
+  void scn_chars(coff::section_characteristics_t chars);
+
+  /// <summary>
+  /// gets the name of the section symbol that the symbol is allocated inside
+  /// of. only data symbols inside of a section have one.
+  /// </summary>
+  /// <returns>the interned name of the section symbol, or no_name.</returns>
+  name_id_t scn_name() const;
+
+  /// <summary>
+  /// sets the name of the section symbol that the symbol is allocated inside
+  /// of.
+  /// </summary>
+  /// <param name="name">the interned name of the section symbol.</param>
+  void scn_name(name_id_t name);
 
   /// <summary>
   /// gets the imagine in which the symbol is located inside of.
   /// </summary>
   /// <returns>the imagine in which the symbol is located inside of.</returns>
-  coff::image_t* img() const;
+  const coff::image_t* img() const;
 
   /// <summary>
   /// returns a vector by reference of bytes containing the data of the symbol.
+  /// if the data of the symbol is borrowed, it is copied into the vector first.
+  /// the data version is bumped since the data may be modified through the
+  /// reference, use bytes to only read the data.
   /// </summary>
   /// <returns>a vector by reference of bytes containing the data of the
   /// symbol.</returns>
-  std::vector<std::uint8_t>& data();
+  bytes_t& data();
+
+  /// <summary>
+  /// appends bytes to the data of the symbol. unlike modifying the data
+  /// through data, the decoded instruction is kept since the instruction at
+  /// the start of the data does not change, unless the bytes moved.
+  /// </summary>
+  /// <param name="bytes">the bytes to append.</param>
+  void append(std::span<const std::uint8_t> bytes);
+
+  /// <summary>
+  /// gets the version of the data of the symbol. it changes every time the
+  /// data may have been modified.
+  /// </summary>
+  /// <returns>the version of the data of the symbol.</returns>
+  std::uint32_t data_version() const;
+
+  /// <summary>
+  /// gets the instruction at the start of the data of the symbol, decoded in
+  /// 64-bit mode. it is decoded the first time it is asked for and cached in
+  /// decode_pool_t until the data version changes, so every pass shares one
+  /// decode. the decoded instruction refers to the bytes it was decoded from,
+  /// so it is decoded again if the bytes moved since. the instruction must be
+  /// copied before it is turned into an encoder request.
+  /// </summary>
+  /// <returns>the decoded instruction, or null if the data does not start
+  /// with a valid instruction.</returns>
+  const xed_decoded_inst_t* decoded();
+
+  /// <summary>
+  /// returns a read only view of the data of the symbol. this never copies.
+  /// </summary>
+  /// <returns>a read only view of the data of the symbol.</returns>
+  std::span<const std::uint8_t> bytes() const;
 
   /// <summary>
   /// returns a pointer to the coff symbol object.
   /// </summary>
   /// <returns>a pointer to the coff symbol object.</returns>
-  coff::symbol_t* sym() const;
+  const coff::symbol_t* sym() const;
 
   /// <summary>
   /// returns the type of the symbol.
@@ -149,7 +272,7 @@ class symbol_t {
   /// returns a vector of relocations.
   /// </summary>
   /// <returns>a vector of relocations.</returns>
-  std::vector<recomp::reloc_t>& relocs();
+  relocs_t& relocs();
 
   /// <summary>
   /// set the address where the symbol is allocated at.
@@ -158,17 +281,18 @@ class symbol_t {
   void allocated_at(std::uintptr_t allocated_at);
 
   /// <summary>
-  /// gets the hash of the symbol name.
+  /// gets the hash of the symbol name. the hash is computed once when the name
+  /// is interned.
   /// </summary>
   /// <returns>the hash of the symbol name.</returns>
-  std::size_t hash();
+  std::size_t hash() const;
 
   /// <summary>
-  /// generate a hash given the name of the symbol.
+  /// generate a hash given the name of the symbol. this interns the name.
   /// </summary>
   /// <param name="sym">the symbol name to create a hash from.</param>
   /// <returns>the symbol name hash</returns>
-  static std::size_t hash(const std::string& sym);
+  static std::size_t hash(std::string_view sym);
 
   /// <summary>
   /// get the name of a symbol. this function will create a symbol name if the
@@ -186,20 +310,33 @@ class symbol_t {
   ///
   ///   .data#section_index!coff_file_timestamp+offset_into_section
   ///
+  /// the name is interned, created names are only built by this function so
+  /// callers that need the name of the same coff symbol more than once should
+  /// keep the id.
   /// </summary>
   /// <param name="img">the coff file containing the symbol.</param>
   /// <param name="sym">the coff symbol itself.</param>
-  /// <returns>the name of the symbol, or a created one.</returns>
-  static std::string name(const coff::image_t* img, coff::symbol_t* sym);
+  /// <returns>the id of the name of the symbol, or a created one.</returns>
+  static name_id_t name(const coff::image_t* img, const coff::symbol_t* sym);
 
  private:
-  std::string m_name;
-  std::uintptr_t m_offset, m_allocated_at;
-  std::vector<std::uint8_t> m_data;
-  coff::section_header_t* m_scn;
-  std::vector<recomp::reloc_t> m_relocs;
+  // fields read by the recomp loops come first so they share a cache line, the
+  // coff back pointers are only needed by decomp and some passes...
+  //
   sym_type_t m_sym_type;
-  coff::symbol_t* m_sym;
-  coff::image_t* m_img;
+  name_id_t m_name;
+  std::uintptr_t m_allocated_at;
+  std::span<const std::uint8_t> m_view;
+  bytes_t m_data;
+  relocs_t m_relocs;
+  std::uintptr_t m_offset;
+  coff::section_characteristics_t m_scn_chars;
+  name_id_t m_scn_name;
+  const coff::section_header_t* m_scn;
+  const coff::symbol_t* m_sym;
+  const coff::image_t* m_img;
+  const std::uint8_t* m_decoded_at;
+  decode_ref_t m_decoded;
+  std::uint32_t m_data_ver, m_decoded_ver;
 };
 }  // namespace theo::decomp
\ No newline at end of file
@@ -30,7 +30,12 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <obf/pass.hpp>
+#include <random>
+#include <span>
+#include <util/parallel.hpp>
+#include <util/stats.hpp>
 #include <vector>
 
 namespace theo::obf {
@@ -43,9 +48,14 @@ using engine_callback_t = std::function<void(decomp::symbol_t*, pass_t*)>;
 /// <summary>
 /// singleton obfuscation engine class. this class is responsible for keeping
 /// track of the registered passes and the order in which to execute them.
+///
+/// a pass runs after every pass that produces something it requires, passes
+/// that are not ordered by their requirements run in the order they were
+/// added.
 /// </summary>
 class engine_t {
-  explicit engine_t(){};
+  explicit engine_t()
+      : m_seed(std::random_device{}()), m_threads(util::hardware_threads()){};
 
  public:
   /// <summary>
@@ -55,23 +65,113 @@ class engine_t {
   static engine_t* get();
 
   /// <summary>
-  /// add a pass to the engine. the order in which you call this function
-  /// matters as the underlying data structure that contains the passes is a
-  /// vector.
+  /// add a pass to the engine and schedule it after the passes that produce
+  /// what it requires. the order in which you call this function only matters
+  /// for passes that are not ordered by their requirements.
   /// </summary>
   /// <param name="pass">a pointer to the pass in which to add to the
   /// engine.</param>
   void add_pass(pass_t* pass);
 
   /// <summary>
-  /// invokes the callback for each pass in order.
+  /// invokes the callback for each pass in scheduled order.
   /// </summary>
   /// <param name="callback">callback to be invoked. the callback is given a
   /// pointer to the pass.</param>
   /// <param name="sym">symbol to run callbacks on.</param>
   void for_each(decomp::symbol_t* sym, engine_callback_t callback);
 
+  /// <summary>
+  /// invokes the callback for each pass that takes symbols of the given type
+  /// in scheduled order. the symbol is not read, so loops over the hot columns
+  /// of the symbol table only touch it when a pass runs.
+  /// </summary>
+  /// <param name="sym">symbol to run callbacks on.</param>
+  /// <param name="type">type of the symbol.</param>
+  /// <param name="callback">callback to be invoked.</param>
+  /// <returns>true if the callback was invoked for any pass.</returns>
+  bool for_each(decomp::symbol_t* sym,
+                decomp::sym_type_t type,
+                engine_callback_t callback);
+
+  /// <summary>
+  /// runs every pass on the symbols of the table in scheduled order. adjacent
+  /// passes that are not global are fused and run together on every thread,
+  /// on batches of symbols or on the instructions of each function. adjacent
+  /// global passes are fused and run on the calling thread with every symbol
+  /// in one batch. passes are given batches through pass_t::batch_pass.
+  /// symbols added by the passes are not visited.
+  /// </summary>
+  /// <param name="sym_tbl">the symbol table to run the passes on.</param>
+  /// <param name="types">mask of the symbol types to run the passes on.</param>
+  /// <param name="from">only symbols added at or after this watermark of the
+  /// symbol table are visited.</param>
+  /// <param name="stats">if not null, a stat is added for every pass of
+  /// every stage that ran. the track of a pass is one plus the order it was
+  /// added in.</param>
+  /// <returns>the number of symbols visited.</returns>
+  std::size_t run(sym_map_t& sym_tbl,
+                  std::uint32_t types,
+                  std::uint32_t from = 0,
+                  util::stats_t* stats = nullptr);
+
+  /// <summary>
+  /// sets the seed of the random numbers drawn by the passes. the output of
+  /// run is the same for the same seed and input no matter how many threads
+  /// are used. by default the seed is random.
+  /// </summary>
+  /// <param name="seed">the seed.</param>
+  void seed(std::uint64_t seed) { m_seed = seed; }
+
+  /// <summary>
+  /// sets the number of threads run uses for passes that are not global.
+  /// </summary>
+  /// <param name="threads">the number of threads, one or less runs every pass
+  /// on the calling thread.</param>
+  void threads(std::uint32_t threads) { m_threads = threads; }
+
  private:
+  // number of symbols in a batch of a stage that is not global or per
+  // function...
+  //
+  static constexpr std::size_t batch_size = 0x100;
+
+  // adjacent passes in scheduled order that run in one traversal of the
+  // symbols. the passes are indices into passes...
+  //
+  struct stage_t {
+    bool serial;
+    std::vector<std::size_t> passes;
+  };
+
+  // what a pass did during one run, updated by every thread. bgn_ns and
+  // end_ns are the start of its first batch and the end of its last one,
+  // cpu_ns is the time spent in it summed over the threads...
+  //
+  struct counters_t {
+    std::atomic<std::uint64_t> bgn_ns = ~std::uint64_t{};
+    std::atomic<std::uint64_t> end_ns;
+    std::atomic<std::uint64_t> cpu_ns;
+    std::atomic<std::uint64_t> syms_visited;
+    std::atomic<std::uint64_t> syms_created;
+    std::atomic<std::uint64_t> bytes_added;
+    std::atomic<std::uint64_t> relocs_added;
+  };
+
+  void schedule();
+  static std::vector<std::vector<decomp::symbol_t*>> split_fns(
+      const std::vector<decomp::symbol_t*>& syms);
+
+  void run_pass(std::size_t idx,
+                std::span<decomp::symbol_t*> batch,
+                sym_map_t& sym_tbl,
+                util::stats_t* stats,
+                counters_t* counters);
+
   std::vector<pass_t*> passes;
+  std::vector<std::size_t> m_order;
+  std::vector<stage_t> m_stages;
+  std::uint64_t m_seed;
+  std::uint32_t m_threads;
 };
 }  // namespace theo::obf
\ No newline at end of file
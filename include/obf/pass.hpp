@@ -31,7 +31,11 @@
 #pragma once
 #include <spdlog/spdlog.h>
 #include <decomp/symbol.hpp>
+#include <span>
+#include <string_view>
+#include <typeinfo>
 #include <obf/transform/gen.hpp>
+#include <recomp/symbol_table.hpp>
 
 #define XED_ENCODER
 extern "C" {
@@ -59,9 +63,71 @@ using allocator_t =
     std::function<std::uintptr_t(std::uint32_t,
                                  coff::section_characteristics_t)>;
 
-// symbol table map associated with the symbol table data structure.
-//
-using sym_map_t = std::map<std::size_t, decomp::symbol_t>;
+/// <summary>
+/// the symbol table handed to passes. this is the table itself and not an
+/// interface over it, passes call it directly so that lookups and inserts are
+/// not virtual calls. passes add symbols with put_symbol, replace existing
+/// ones with replace and look them up with sym_from_hash.
+/// </summary>
+using sym_map_t = recomp::symbol_table_t;
+
+/// <summary>
+/// what a pass reads and writes when it runs on a symbol. this decides whether
+/// engine_t can run the pass on many symbols at the same time.
+/// </summary>
+enum pass_scope_t {
+  /// <summary>
+  /// the pass only touches the symbol it is given and never adds symbols to
+  /// the table. it runs on every thread.
+  /// </summary>
+  per_symbol,
+
+  /// <summary>
+  /// the pass touches the symbol it is given and the other instructions of the
+  /// same function. it runs on every thread, one function per thread.
+  /// </summary>
+  per_function,
+
+  /// <summary>
+  /// the pass may touch any symbol or add symbols to the table. it runs on one
+  /// thread, one symbol at a time.
+  /// </summary>
+  global
+};
+
+/// <summary>
+/// what passes require and produce. engine_t runs a pass after every added
+/// pass that produces something it requires. a requirement no added pass
+/// produces is ignored. custom passes can declare their own artifacts starting
+/// at user_artifacts.
+/// </summary>
+enum pass_artifact_t {
+  no_artifacts = 0,
+
+  /// <summary>
+  /// instruction symbols split out of functions. each has a relocation with
+  /// offset zero to the next instruction.
+  /// </summary>
+  split_instructions = 1 << 0,
+
+  /// <summary>
+  /// the relocations inside of instructions are transformed.
+  /// </summary>
+  reloc_transforms = 1 << 1,
+
+  /// <summary>
+  /// the relocations to the next instruction are turned into push/ret. the
+  /// relocation no longer has offset zero afterwards.
+  /// </summary>
+  next_inst_transforms = 1 << 2,
+
+  /// <summary>
+  /// conditional branches are rewritten to branch to an instruction symbol.
+  /// </summary>
+  jcc_rewrites = 1 << 3,
+
+  user_artifacts = 1 << 16
+};
 
 /// <summary>
 /// the pass_t class is a base clase for all passes made. you must override the
@@ -79,7 +145,20 @@ class pass_t {
   /// <param name="sym_type">the type of symbol in which the pass will run on.
   /// every symbol passed to the virtual "run" instruction will be of this
   /// type.</param>
-  explicit pass_t(decomp::sym_type_t sym_type) : m_sym_type(sym_type){};
+  /// <param name="scope">what the pass touches when it runs on a symbol. passes
+  /// are global unless they say otherwise.</param>
+  /// <param name="required">mask of pass_artifact_t the pass must run
+  /// after.</param>
+  /// <param name="produced">mask of pass_artifact_t the pass
+  /// produces.</param>
+  explicit pass_t(decomp::sym_type_t sym_type,
+                  pass_scope_t scope = pass_scope_t::global,
+                  std::uint32_t required = pass_artifact_t::no_artifacts,
+                  std::uint32_t produced = pass_artifact_t::no_artifacts)
+      : m_sym_type(sym_type),
+        m_scope(scope),
+        m_required(required),
+        m_produced(produced){};
 
   /// <summary>
   /// This virtual method is invoked before the recomp stage of Theodosius. This
@@ -88,6 +167,19 @@ class pass_t {
   /// <param name="sym">a symbol of the same type of m_sym_type.</param>
   virtual void generic_pass(decomp::symbol_t* sym, sym_map_t& sym_tbl) = 0;
 
+  /// <summary>
+  /// This virtual method is invoked by engine_t with a batch of symbols of the
+  /// same type as m_sym_type, such as the instructions of a function. override
+  /// it to do setup work once per batch instead of once per symbol. by default
+  /// generic_pass is invoked for each symbol in order.
+  /// </summary>
+  /// <param name="syms">the batch of symbols.</param>
+  virtual void batch_pass(std::span<decomp::symbol_t*> syms,
+                          sym_map_t& sym_tbl) {
+    for (auto sym : syms)
+      generic_pass(sym, sym_tbl);
+  }
+
   /// <summary>
   /// This virtual method is invoked prior to calling the "copier". This allows
   /// you to manipulate the symbol prior to it being copied into memory.
@@ -129,14 +221,41 @@ class pass_t {
       recomp::reloc_t* reloc,
       std::uintptr_t allocated_t) = 0;
 
+  /// <summary>
+  /// gets the name of the pass as it is shown in stats and traces. defaults to
+  /// the name of the class given by typeid, override it for a readable name.
+  /// </summary>
+  /// <returns>the name of the pass.</returns>
+  virtual std::string_view name() { return typeid(*this).name(); }
+
   /// <summary>
   /// gets the passes symbol type.
   /// </summary>
   /// <returns>the passes symbol type.</returns>
   decomp::sym_type_t sym_type() { return m_sym_type; }
 
+  /// <summary>
+  /// gets the passes scope.
+  /// </summary>
+  /// <returns>the passes scope.</returns>
+  pass_scope_t scope() { return m_scope; }
+
+  /// <summary>
+  /// gets the artifacts the pass requires.
+  /// </summary>
+  /// <returns>mask of pass_artifact_t the pass must run after.</returns>
+  std::uint32_t required() { return m_required; }
+
+  /// <summary>
+  /// gets the artifacts the pass produces.
+  /// </summary>
+  /// <returns>mask of pass_artifact_t the pass produces.</returns>
+  std::uint32_t produced() { return m_produced; }
+
  private:
   decomp::sym_type_t m_sym_type;
+  pass_scope_t m_scope;
+  std::uint32_t m_required, m_produced;
 };
 
 /// <summary>
@@ -146,7 +265,12 @@ class pass_t {
 /// </summary>
 class generic_pass_t : public pass_t {
  public:
-  explicit generic_pass_t(decomp::sym_type_t sym_type) : pass_t(sym_type) {}
+  explicit generic_pass_t(
+      decomp::sym_type_t sym_type,
+      pass_scope_t scope = pass_scope_t::global,
+      std::uint32_t required = pass_artifact_t::no_artifacts,
+      std::uint32_t produced = pass_artifact_t::no_artifacts)
+      : pass_t(sym_type, scope, required, produced) {}
 
   // default non-generic passes to return generic values...
   //
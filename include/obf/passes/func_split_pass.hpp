@@ -33,10 +33,15 @@
 
 namespace theo::obf {
 class func_split_pass_t : public generic_pass_t {
-  explicit func_split_pass_t() : generic_pass_t(decomp::sym_type_t::function) {}
+  explicit func_split_pass_t()
+      : generic_pass_t(decomp::sym_type_t::function,
+                       pass_scope_t::global,
+                       pass_artifact_t::no_artifacts,
+                       pass_artifact_t::split_instructions) {}
 
  public:
   static func_split_pass_t* get();
   void generic_pass(decomp::symbol_t* sym, sym_map_t& sym_tbl) override;
+  std::string_view name() override { return "func_split_pass_t"; }
 };
 }  // namespace theo::obf
\ No newline at end of file
@@ -60,10 +60,18 @@ namespace theo::obf {
 /// </summary>
 class jcc_rewrite_pass_t : public generic_pass_t {
   explicit jcc_rewrite_pass_t()
-      : generic_pass_t(decomp::sym_type_t::instruction) {}
+      : generic_pass_t(decomp::sym_type_t::instruction,
+                       pass_scope_t::per_symbol,
+                       // the relocation to the branch is transformed by
+                       // calling next_inst_pass_t, which would otherwise take
+                       // the relocation to the next instruction instead...
+                       pass_artifact_t::split_instructions |
+                           pass_artifact_t::next_inst_transforms,
+                       pass_artifact_t::jcc_rewrites) {}
 
  public:
   static jcc_rewrite_pass_t* get();
   void generic_pass(decomp::symbol_t* sym, sym_map_t& sym_tbl) override;
+  std::string_view name() override { return "jcc_rewrite_pass_t"; }
 };
 }  // namespace theo::obf
\ No newline at end of file
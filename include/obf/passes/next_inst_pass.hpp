@@ -84,7 +84,15 @@ namespace theo::obf {
 /// </summary>
 class next_inst_pass_t : public generic_pass_t {
   explicit next_inst_pass_t()
-      : generic_pass_t(decomp::sym_type_t::instruction) {
+      : generic_pass_t(decomp::sym_type_t::instruction,
+                       pass_scope_t::per_symbol,
+                       // the relocation to the next instruction no longer
+                       // has offset zero afterwards, reloc_transform_pass_t
+                       // would take it for a relocation inside of the
+                       // instruction...
+                       pass_artifact_t::split_instructions |
+                           pass_artifact_t::reloc_transforms,
+                       pass_artifact_t::next_inst_transforms) {
     xed_state_t istate{XED_MACHINE_MODE_LONG_64, XED_ADDRESS_WIDTH_64b};
     xed_decoded_inst_zero_set_mode(&m_tmp_inst, &istate);
     xed_decode(&m_tmp_inst, m_type_inst_bytes, sizeof(m_type_inst_bytes));
@@ -93,6 +101,7 @@ class next_inst_pass_t : public generic_pass_t {
  public:
   static next_inst_pass_t* get();
   void generic_pass(decomp::symbol_t* sym, sym_map_t& sym_tbl) override;
+  std::string_view name() override { return "next_inst_pass_t"; }
 
  private:
   std::optional<recomp::reloc_t*> has_next_inst_reloc(decomp::symbol_t*);
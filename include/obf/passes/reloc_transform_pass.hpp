@@ -55,11 +55,15 @@ namespace theo::obf {
 /// </summary>
 class reloc_transform_pass_t : public generic_pass_t {
   explicit reloc_transform_pass_t()
-      : generic_pass_t(decomp::sym_type_t::instruction) {}
+      : generic_pass_t(decomp::sym_type_t::instruction,
+                       pass_scope_t::per_symbol,
+                       pass_artifact_t::split_instructions,
+                       pass_artifact_t::reloc_transforms) {}
 
  public:
   static reloc_transform_pass_t* get();
   void generic_pass(decomp::symbol_t* sym, sym_map_t& sym_tbl) override;
+  std::string_view name() override { return "reloc_transform_pass_t"; }
 
  private:
   std::optional<recomp::reloc_t*> has_legit_reloc(decomp::symbol_t* sym);
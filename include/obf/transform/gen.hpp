@@ -49,6 +49,7 @@ inline std::vector<std::uint8_t> generate(xed_decoded_inst_t* inst,
   auto num_transforms = transform::operation_t::random(low, high);
   auto num_ops = transform::operations.size();
   std::vector<std::uint8_t> new_inst_bytes;
+  std::vector<recomp::transform_entry_t> chain;
 
   std::uint32_t inst_len = {};
   std::uint8_t inst_buff[XED_MAX_INSTRUCTION_BYTES];
@@ -71,8 +72,9 @@ inline std::vector<std::uint8_t> generate(xed_decoded_inst_t* inst,
     new_inst_bytes.insert(new_inst_bytes.end(), transform_bytes.begin(),
                           transform_bytes.end());
 
-    reloc->add_transform(
-        {transform::operations[itr->second->inverse()]->get_transform(), imm});
+    chain.push_back(
+        {transform::operations.at(itr->second->inverse())->get_transform(),
+         imm});
   }
 
   xed_encoder_request_zero_set_mode(&req, &istate);
@@ -83,7 +85,8 @@ inline std::vector<std::uint8_t> generate(xed_decoded_inst_t* inst,
 
   // inverse the order in which the transformations are executed...
   //
-  std::reverse(reloc->get_transforms().begin(), reloc->get_transforms().end());
+  std::reverse(chain.begin(), chain.end());
+  reloc->set_transforms(chain);
   return new_inst_bytes;
 }
 }  // namespace theo::obf::transform
\ No newline at end of file
@@ -123,7 +123,7 @@ class operation_t {
   /// gets the inverse operation of the current operation.
   /// </summary>
   /// <returns>the inverse operation of the current operation.</returns>
-  xed_iclass_enum_t inverse() { return m_inverse_op[m_type]; }
+  xed_iclass_enum_t inverse() { return m_inverse_op.at(m_type); }
 
   /// <summary>
   /// gets a pointer to the lambda function which contains the transform logic.
@@ -146,13 +146,26 @@ class operation_t {
   /// <param name="largest">highest value of the range.</param>
   /// <returns>a random value in a range.</returns>
   static std::size_t random(std::size_t lowest, std::size_t largest) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_int_distribution<std::size_t> distr(lowest, largest);
-    return distr(gen);
+    return distr(rng());
   }
 
+  /// <summary>
+  /// seeds the random number generator of the calling thread. random returns
+  /// the same values after the same seed no matter which thread calls it.
+  /// </summary>
+  /// <param name="seed">the seed.</param>
+  static void seed(std::uint64_t seed) { rng().seed(seed); }
+
  private:
+  // every thread has its own generator so passes running on different threads
+  // dont share state. it is seeded randomly until seed is called...
+  //
+  static std::mt19937_64& rng() {
+    thread_local std::mt19937_64 gen(std::random_device{}());
+    return gen;
+  }
+
   transform_t m_transform;
   xed_iclass_enum_t m_type;
 
@@ -30,10 +30,15 @@
 #pragma once
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
+#include <decomp/name_pool.hpp>
 #include <obf/transform/transform.hpp>
+#include <recomp/transform_pool.hpp>
 namespace theo::recomp {
 /// <summary>
-/// meta data about a relocation for a symbol
+/// meta data about a relocation for a symbol. this is a small trivially
+/// copyable value, the name of the symbol is interned and the transformations
+/// are stored in the transform_pool_t.
 /// </summary>
 class reloc_t {
  public:
@@ -43,23 +48,28 @@ class reloc_t {
   /// <param name="offset">offset into the symbol data where the relocation is
   /// at. all relocations are assumed to be linear virtual addresses of the
   /// symbol.</param>
-  /// <param name="hash">hash of the symbol to which the relocation is
-  /// of.</param> <param name="sym_name">the name of the symbol to which the
+  /// <param name="sym_name">the interned name of the symbol to which the
   /// relocation is of.</param>
-  explicit reloc_t(std::uint32_t offset,
-                   std::size_t hash,
-                   const std::string&& sym_name)
-      : m_offset(offset), m_hash(hash), m_sym_name(sym_name) {}
+  explicit reloc_t(std::uint32_t offset, decomp::name_id_t sym_name)
+      : m_offset(offset), m_sym_name(sym_name), m_chain(0), m_chain_len(0) {}
   /// <summary>
   /// returns the hash of the relocation symbol.
   /// </summary>
   /// <returns>hash of the relocation symbol</returns>
-  std::size_t hash() { return m_hash; }
+  std::size_t hash() { return decomp::name_pool_t::get()->hash(m_sym_name); }
   /// <summary>
   /// returns the name of the relocation symbol.
   /// </summary>
   /// <returns>returns the name of the relocation symbol.</returns>
-  std::string name() { return m_sym_name; }
+  std::string_view name() {
+    return decomp::name_pool_t::get()->name(m_sym_name);
+  }
+  /// <summary>
+  /// returns the id of the interned name of the relocation symbol.
+  /// </summary>
+  /// <returns>returns the id of the interned name of the relocation
+  /// symbol.</returns>
+  decomp::name_id_t name_id() { return m_sym_name; }
   /// <summary>
   /// returns the offset into the symbol to which the relocation will be
   /// applied. the offset is in bytes. zero based.
@@ -74,30 +84,42 @@ class reloc_t {
   /// too.</param>
   void offset(std::uint32_t offset) { m_offset = offset; }
   /// <summary>
-  /// adds a transformation to be applied to the relocation prior to writing it
-  /// into the symbol.
+  /// sets the transformations to be applied to the relocation prior to writing
+  /// it into the symbol. the chain is copied into the transform_pool_t.
   /// </summary>
-  /// <param name="entry">a pair containing a lambda function that when executed
-  /// transforms a relocation. the second value in the pair is a random value
-  /// which is passed to the lambda.</param>
-  void add_transform(
-      std::pair<obf::transform::transform_t*, std::uint32_t> entry) {
-    m_transforms.push_back(entry);
+  /// <param name="chain">pairs containing a lambda function that when executed
+  /// transforms a relocation, and a random value which is passed to the
+  /// lambda. they are applied in order.</param>
+  void set_transforms(std::span<const transform_entry_t> chain) {
+    release_transforms();
+    m_chain = transform_pool_t::get()->add(chain);
+    m_chain_len = chain.size();
   }
   /// <summary>
-  /// gets the vector of transformation.
+  /// gets the transformations of the relocation.
   /// </summary>
-  /// <returns>returns the vector of transformations.</returns>
-  std::vector<std::pair<obf::transform::transform_t*, std::uint32_t>>&
-  get_transforms() {
-    return m_transforms;
+  /// <returns>returns the transformations in the order they are
+  /// applied.</returns>
+  std::span<const transform_entry_t> get_transforms() {
+    return transform_pool_t::get()->chain(m_chain, m_chain_len);
+  }
+  /// <summary>
+  /// gives the transformations of the relocation back to the
+  /// transform_pool_t. the symbol table does so when the symbol of the
+  /// relocation leaves it.
+  /// </summary>
+  void release_transforms() {
+    transform_pool_t::get()->release(m_chain, m_chain_len);
+    m_chain = m_chain_len = 0;
   }
 
  private:
-  std::vector<std::pair<obf::transform::transform_t*, std::uint32_t>>
-      m_transforms;
-  std::string m_sym_name;
-  std::size_t m_hash;
   std::uint32_t m_offset;
+  decomp::name_id_t m_sym_name;
+  std::uint32_t m_chain;
+  std::uint32_t m_chain_len;
 };
+
+static_assert(std::is_trivially_copyable_v<reloc_t>,
+              "relocations are copied around by value");
 }  // namespace theo::recomp
\ No newline at end of file
@@ -30,42 +30,126 @@
 
 #pragma once
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <functional>
-#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include <decomp/symbol.hpp>
+#include <util/segments.hpp>
 
 namespace theo::recomp {
 /// <summary>
-/// this class is a high level wrapper for a hashmap that contains
-/// decomp::symbol_t values. the symbol values are references by a hashcode.
+/// the fields of every symbol that the recomp loops read, stored column by
+/// column (structure of arrays). row n of every column describes the symbol
+/// at index n of the arena, so rows are in the order symbols were added. the
+/// rows are kept up to date by the symbol table as symbols are added, replaced
+/// and erased, an erased symbol keeps its row with a null symbol and no type.
+/// copied is written by recomp_t, a row is set if a copier pass copied the
+/// symbol.
+/// </summary>
+struct hot_syms_t {
+  std::vector<decomp::symbol_t*> syms;
+  std::vector<decomp::sym_type_t> types;
+  std::vector<std::uint32_t> sizes;
+  std::vector<std::uintptr_t> allocs;
+  std::vector<const std::uint8_t*> data;
+  std::vector<std::span<reloc_t>> relocs;
+  std::vector<coff::section_characteristics_t> chars;
+  std::vector<bool> copied;
+};
+
+/// <summary>
+/// this class is a hash table of decomp::symbol_t values referenced by the hash
+/// of their name. symbols are stored contiguously in segments (an arena) so
+/// their addresses never change once added, the index is an open addressing
+/// table of (hash, symbol index) with linear probing.
+///
+/// the index is split into shards picked by the top bits of the hash, each
+/// with its own lock, so threads adding different symbols rarely wait on each
+/// other. every segment is twice the size of the one before it (see
+/// util::segment_of), so the directory of segments is a small fixed array
+/// that readers never see move.
+/// put_symbol, replace, refresh, sym_from_hash and both for_each may be called
+/// from any number of threads at once. a symbol itself is not locked, only the
+/// thread that owns a symbol in a pass may change or replace it.
+///
+/// the fields the recomp loops read are also kept in columns (see hot_syms_t).
+/// a symbol that is changed through a pointer into the table must be
+/// refreshed so that its row matches it again, engine_t does so for every
+/// symbol it hands to a pass.
 /// </summary>
 class symbol_table_t {
  public:
   /// <summary>
   /// default constructor. does nothing.
   /// </summary>
-  symbol_table_t() {}
+  symbol_table_t()
+      : m_size(0),
+        m_num_erased(0),
+        m_allocs_stale(true),
+        m_types_stale(false) {}
 
   /// <summary>
-  /// this constructor will populate the m_table private field with symbols.
+  /// this constructor will populate the table with symbols. the symbols are
+  /// moved into the table.
   /// </summary>
   /// <param name="syms">vector of decomp::symbol_t</param>
-  symbol_table_t(const std::vector<decomp::symbol_t>&& syms);
+  symbol_table_t(std::vector<decomp::symbol_t>&& syms);
 
   /// <summary>
-  /// add symbol to m_table
+  /// destroys every symbol in the arena.
+  /// </summary>
+  ~symbol_table_t();
+
+  symbol_table_t(const symbol_table_t&) = delete;
+  symbol_table_t& operator=(const symbol_table_t&) = delete;
+
+  /// <summary>
+  /// move a symbol into the table. safe to call from multiple threads at once,
+  /// including from inside of for_each.
   /// </summary>
   /// <param name="sym">symbol to be added.</param>
-  void put_symbol(decomp::symbol_t& sym);
+  /// <returns>pointer to the symbol in the table. if a symbol with the same
+  /// name was already in the table, that symbol is returned. null if a symbol
+  /// with another name but the same hash is in the table or the table is full,
+  /// the symbol is not added.</returns>
+  decomp::symbol_t* put_symbol(decomp::symbol_t&& sym);
 
   /// <summary>
-  /// add a vector of symbol to m_table
+  /// move a vector of symbol into the table. safe to call from multiple threads
+  /// at once.
   /// </summary>
   /// <param name="syms"></param>
-  void put_symbols(std::vector<decomp::symbol_t>& syms);
+  /// <returns>false if a symbol was not added, see put_symbol.</returns>
+  bool put_symbols(std::vector<decomp::symbol_t>&& syms);
+
+  /// <summary>
+  /// moves a symbol into the table, or replaces the symbol with the same hash
+  /// if there is one. the replaced symbol keeps its address. this may be called
+  /// from inside of for_each, but only by the thread visiting that symbol.
+  /// </summary>
+  /// <param name="sym">symbol to be added.</param>
+  /// <returns>pointer to the symbol in the table. null if a symbol with another
+  /// name but the same hash is in the table, it is not replaced, or if the
+  /// symbol is new and the table is full.</returns>
+  decomp::symbol_t* replace(decomp::symbol_t&& sym);
+
+  /// <summary>
+  /// removes a symbol from the table and destroys it. the place of the symbol
+  /// in the arena is not reused. this must not be called while the table is
+  /// traversed or while other threads use the symbol.
+  /// </summary>
+  /// <param name="hash">hash of the name of the symbol to remove.</param>
+  /// <returns>false if there is no symbol with the hash.</returns>
+  bool erase(std::size_t hash);
 
   /// <summary>
   /// returns an optional pointer to a symbol from the symbol table given the
@@ -85,27 +169,285 @@ class symbol_table_t {
   /// theo::decomp::symbol_t</returns>
   std::optional<decomp::symbol_t*> sym_from_alloc(std::uintptr_t allocated_at);
 
+  /// <summary>
+  /// returns the symbol whose allocation [allocated_at, allocated_at + size)
+  /// contains an address, and the offset of the address inside of it. symbols
+  /// without a size (such as data symbols inside of a section symbol) never
+  /// contain an address, the section symbol does.
+  /// </summary>
+  /// <param name="addr">the address to look up.</param>
+  /// <returns>the symbol that contains the address and the offset of the
+  /// address into the symbol.</returns>
+  std::optional<std::pair<decomp::symbol_t*, std::uintptr_t>> sym_from_addr(
+      std::uintptr_t addr);
+
+  /// <summary>
+  /// gets the hot fields of every symbol in columns, so loops that only need
+  /// those fields stream through a few contiguous arrays instead of every
+  /// symbol. the columns are kept up to date as symbols are added, they are
+  /// not rebuilt. the columns must not be read while other threads add
+  /// symbols, since that may grow them.
+  /// </summary>
+  /// <returns>the hot fields of every symbol, one row per index of the
+  /// arena.</returns>
+  const hot_syms_t& hot();
+
+  /// <summary>
+  /// copies the hot fields of symbols that were changed through a pointer into
+  /// their rows. symbols that are not in the table are skipped. safe to call
+  /// from multiple threads at once.
+  /// </summary>
+  /// <param name="syms">the symbols that were changed.</param>
+  void refresh(std::span<decomp::symbol_t* const> syms);
+
+  /// <summary>
+  /// copies the hot fields of a symbol into its row.
+  /// </summary>
+  /// <param name="row">row of the symbol.</param>
+  void refresh(std::uint32_t row);
+
+  /// <summary>
+  /// gets the row of a symbol in the hot columns given the hash of its name.
+  /// </summary>
+  /// <param name="hash">hash of the name of the symbol.</param>
+  /// <returns>the row of the symbol, no value if it is not in the
+  /// table.</returns>
+  std::optional<std::uint32_t> row_of(std::size_t hash);
+
+  /// <summary>
+  /// sets where the symbol of a row is allocated, in its row and in the symbol
+  /// since passes read it from the symbol.
+  /// </summary>
+  /// <param name="row">row of the symbol.</param>
+  /// <param name="allocated_at">where the symbol is allocated at.</param>
+  void allocated_at(std::uint32_t row, std::uintptr_t allocated_at);
+
+  /// <summary>
+  /// gets the data of the symbol of a row for modification, see
+  /// decomp::symbol_t::data. the data is copied out of the lib if it is
+  /// borrowed, the row is updated to the copy.
+  /// </summary>
+  /// <param name="row">row of the symbol.</param>
+  /// <returns>the data of the symbol.</returns>
+  decomp::bytes_t& data(std::uint32_t row);
+
+  /// <summary>
+  /// records whether the symbol of a row was copied by a copier pass.
+  /// </summary>
+  /// <param name="row">row of the symbol.</param>
+  /// <param name="copied">true if the symbol was copied.</param>
+  void copied(std::uint32_t row, bool copied);
+
+  /// <summary>
+  /// builds the sorted index of symbol allocations used by sym_from_alloc and
+  /// sym_from_addr. recomp_t calls this once every symbol is allocated. the
+  /// index is rebuilt on the next lookup if symbols are added, call this
+  /// again if symbols are reallocated. the allocation index and its lookups are
+  /// not safe to use while symbols are being added.
+  /// </summary>
+  void index_allocs();
+
   /// <summary>
   /// this function is a wrapper function that allows you to get at each entry
-  /// in the symbol table by reference.
+  /// in the symbol table by reference. symbols are visited in the order they
+  /// were added. only the symbols in the table when the call began are
+  /// visited, symbols added during the traversal (by the callback or by
+  /// another thread) are not.
   /// </summary>
   /// <param name="fn">a callback function that will be called for each
   /// symbol</param>
   void for_each(std::function<void(decomp::symbol_t& sym)> fn);
 
   /// <summary>
-  /// returns the size of the symbol table.
+  /// calls a callback for each symbol of the given types. only the symbols of
+  /// those types are visited, the table keeps an index of the symbols of each
+  /// type. symbols are visited type by type in the order they were added. the
+  /// indices are copied when the call begins so symbols added during the
+  /// traversal are not visited.
+  /// </summary>
+  /// <param name="types">mask of decomp::sym_type_t values.</param>
+  /// <param name="fn">a callback function that will be called for each
+  /// symbol</param>
+  void for_each(std::uint32_t types,
+                std::function<void(decomp::symbol_t& sym)> fn);
+
+  /// <summary>
+  /// calls a callback for each symbol of the given types that was added at or
+  /// after a watermark.
+  /// </summary>
+  /// <param name="types">mask of decomp::sym_type_t values.</param>
+  /// <param name="from">a value returned by watermark.</param>
+  /// <param name="fn">a callback function that will be called for each
+  /// symbol</param>
+  void for_each(std::uint32_t types,
+                std::uint32_t from,
+                std::function<void(decomp::symbol_t& sym)> fn);
+
+  /// <summary>
+  /// returns the number of symbols in the table.
   /// </summary>
-  /// <returns>returns the size of the symbol table.</returns>
+  /// <returns>returns the number of symbols in the table.</returns>
   std::uint32_t size();
 
   /// <summary>
-  /// getter for underlying symbol hash map.
+  /// returns a position in the order symbols are added. symbols are never
+  /// moved, so for_each with this value visits only the symbols added after
+  /// this call.
   /// </summary>
-  /// <returns>returns the symbol hashmap.</returns>
-  std::map<std::size_t, decomp::symbol_t>& get();
+  /// <returns>the number of symbols ever added to the table.</returns>
+  std::uint32_t watermark();
 
  private:
-  std::map<std::size_t, decomp::symbol_t> m_table;
+  /// <summary>
+  /// an entry of the open addressing index. idx is the index of the symbol in
+  /// the arena plus one, zero means the entry is empty.
+  /// </summary>
+  struct slot_t {
+    std::size_t hash;
+    std::uint32_t idx;
+  };
+
+  /// <summary>
+  /// an entry of the allocation index. idx is the row of the symbol in the hot
+  /// columns and breaks ties between symbols allocated at the same address.
+  /// </summary>
+  struct alloc_t {
+    std::uintptr_t bgn;
+    std::uintptr_t end;
+    std::uint32_t idx;
+    decomp::symbol_t* sym;
+  };
+
+  /// <summary>
+  /// raw storage for a symbol in the arena.
+  /// </summary>
+  struct alignas(decomp::symbol_t) storage_t {
+    std::uint8_t data[sizeof(decomp::symbol_t)];
+  };
+
+  /// <summary>
+  /// one shard of the index. slots is an open addressing table holding the
+  /// hashes whose top bits select this shard, used is the number of slots
+  /// that are taken.
+  /// </summary>
+  struct shard_t {
+    std::shared_mutex mtx;
+    std::vector<slot_t> slots;
+    std::uint32_t used = 0;
+  };
+
+  static constexpr std::size_t seg_base = 0x100;
+  static constexpr std::size_t max_syms = 0xFFFFFFFF;
+  static constexpr std::size_t max_segs =
+      util::segment_of(max_syms - 1, seg_base).first + 1;
+  static constexpr std::size_t num_shards = 0x40;
+  static constexpr std::size_t num_types = 4;
+  static constexpr std::size_t min_slots = 0x40;
+
+  /// <summary>
+  /// inserts a symbol into the table. if a symbol with the same hash is already
+  /// in the table it is kept, a symbol with a different name but the same hash
+  /// is reported as a collision.
+  /// </summary>
+  /// <param name="sym">symbol to be added.</param>
+  /// <returns>pointer to the symbol in the table, or null on a collision or
+  /// if the table is full.</returns>
+  decomp::symbol_t* insert(decomp::symbol_t&& sym);
+
+  /// <summary>
+  /// returns the shard of the index that a hash belongs to.
+  /// </summary>
+  /// <param name="hash">hash of the symbol name.</param>
+  /// <returns>reference to the shard.</returns>
+  shard_t& shard_of(std::size_t hash);
+
+  /// <summary>
+  /// finds the index slot for a hash, growing the shard first if needed. the
+  /// shard must be locked exclusively.
+  /// </summary>
+  /// <param name="shard">the shard of the hash.</param>
+  /// <param name="hash">hash of the symbol name.</param>
+  /// <returns>the slot that holds the hash, or the empty slot where it would
+  /// be inserted.</returns>
+  slot_t& find_slot(shard_t& shard, std::size_t hash);
+
+  /// <summary>
+  /// returns true if the symbol at an index of the arena was erased.
+  /// </summary>
+  /// <param name="idx">index of the symbol.</param>
+  /// <returns>true if the symbol was erased.</returns>
+  bool erased(std::uint32_t idx);
+
+  /// <summary>
+  /// gets a symbol in the arena by index.
+  /// </summary>
+  /// <param name="idx">index of the symbol.</param>
+  /// <returns>reference to the symbol.</returns>
+  decomp::symbol_t& at(std::uint32_t idx);
+
+  /// <summary>
+  /// moves a symbol to the end of the arena and indexes it. the shard that
+  /// owns the slot must be locked exclusively.
+  /// </summary>
+  /// <param name="shard">the shard that owns the slot.</param>
+  /// <param name="slot">the empty slot for the symbol.</param>
+  /// <param name="sym">symbol to be added.</param>
+  /// <returns>pointer to the symbol in the arena, null if the arena already
+  /// holds max_syms symbols.</returns>
+  decomp::symbol_t* emplace(shard_t& shard,
+                            slot_t& slot,
+                            decomp::symbol_t&& sym);
+
+  /// <summary>
+  /// doubles the number of slots in a shard and reinserts its entries.
+  /// </summary>
+  /// <param name="shard">the shard to grow.</param>
+  void grow(shard_t& shard);
+
+  /// <summary>
+  /// gives the transformations of the relocations of a symbol that leaves the
+  /// table back to the transform_pool_t.
+  /// </summary>
+  /// <param name="sym">the symbol.</param>
+  void release(decomp::symbol_t& sym);
+
+  /// <summary>
+  /// gets the row of a symbol from its address. m_arena_mtx must be held.
+  /// </summary>
+  /// <param name="sym">the symbol.</param>
+  /// <returns>the row of the symbol, no value if it is not in the
+  /// arena.</returns>
+  std::optional<std::uint32_t> row_at(const decomp::symbol_t* sym);
+
+  /// <summary>
+  /// copies the hot fields of a symbol into its row. m_arena_mtx must be held.
+  /// </summary>
+  /// <param name="idx">index of the symbol in the arena.</param>
+  /// <returns>true if the type of the symbol is not the type of the
+  /// row.</returns>
+  bool hot_row(std::uint32_t idx);
+
+  /// <summary>
+  /// records the type of a symbol and adds it to the index of that type.
+  /// m_types_mtx must be held.
+  /// </summary>
+  /// <param name="idx">index of the symbol in the arena.</param>
+  /// <param name="type">type of the symbol.</param>
+  void index_type(std::uint32_t idx, decomp::sym_type_t type);
+
+  std::array<std::unique_ptr<storage_t[]>, max_segs> m_segs;
+  std::atomic<std::uint32_t> m_size;
+  std::vector<bool> m_erased;
+  std::uint32_t m_num_erased;
+  std::mutex m_arena_mtx;
+  std::array<shard_t, num_shards> m_shards;
+  hot_syms_t m_hot;
+  std::vector<alloc_t> m_allocs;
+  std::vector<alloc_t> m_extents;
+  std::atomic<bool> m_allocs_stale;
+  std::array<std::vector<std::uint32_t>, num_types> m_types;
+  std::vector<decomp::sym_type_t> m_type_of;
+  bool m_types_stale;
+  std::mutex m_types_mtx;
 };
-}  // namespace theo::recomp
\ No newline at end of file
+}  // namespace theo::recomp
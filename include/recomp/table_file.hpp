@@ -0,0 +1,159 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include <decomp/file_map.hpp>
+#include <recomp/symbol_table.hpp>
+
+namespace theo::recomp {
+/// <summary>
+/// a symbol table written to disk after decomposition so that later runs on
+/// the same lib and entry point can skip decomposition. the file is position
+/// independent, every reference inside of it is an offset from the start of
+/// the file, so it is mapped back read only and its records are read in
+/// place. symbol bytes are views into the mapping, only the names are
+/// interned when the file is loaded.
+///
+/// files are keyed by the hash of the lib and the entry point symbol (see
+/// table_file_t::key) and carry a version that is bumped whenever the layout
+/// changes. a file with another key or version is ignored.
+///
+/// relocation transformations are not saved, the file is meant to be written
+/// before the obfuscation passes run.
+/// </summary>
+class table_file_t {
+ public:
+  /// <summary>
+  /// maps a table file. if the file does not exist or fails to map, load will
+  /// fail.
+  /// </summary>
+  /// <param name="path">path to the table file.</param>
+  explicit table_file_t(const std::filesystem::path& path);
+
+  /// <summary>
+  /// puts the symbols of the file into a symbol table. the symbols view the
+  /// mapping so this object must outlive the table.
+  /// </summary>
+  /// <param name="key">the key the file must have.</param>
+  /// <param name="tbl">the symbol table to populate.</param>
+  /// <returns>false if the file is missing, malformed, of another version or
+  /// of another key. nothing is added to the table in that case.</returns>
+  bool load(std::uint64_t key, symbol_table_t* tbl);
+
+  /// <summary>
+  /// writes a symbol table to a file. the file is written next to the path
+  /// and renamed into place so a reader never maps a partial file.
+  /// </summary>
+  /// <param name="path">path to the table file.</param>
+  /// <param name="key">the key of the file.</param>
+  /// <param name="tbl">the symbol table to write.</param>
+  /// <returns>false if the file could not be written.</returns>
+  static bool save(const std::filesystem::path& path,
+                   std::uint64_t key,
+                   symbol_table_t* tbl);
+
+  /// <summary>
+  /// computes the key of a table file from the bytes of the lib and the
+  /// entry point symbol.
+  /// </summary>
+  /// <param name="lib">the bytes of the lib file.</param>
+  /// <param name="entry_sym">the entry point symbol name.</param>
+  /// <returns>the key.</returns>
+  static std::uint64_t key(std::span<const std::uint8_t> lib,
+                           std::string_view entry_sym);
+
+ private:
+  /// <summary>
+  /// the header at the start of a table file. every offset is from the start
+  /// of the file and aligned to eight bytes.
+  /// </summary>
+  struct header_t {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint64_t size;
+    std::uint32_t num_syms;
+    std::uint32_t num_relocs;
+    std::uint32_t num_names;
+    std::uint32_t reserved;
+    std::uint64_t syms;
+    std::uint64_t relocs;
+    std::uint64_t names;
+    std::uint64_t strs;
+    std::uint64_t strs_size;
+    std::uint64_t data;
+    std::uint64_t data_size;
+  };
+
+  /// <summary>
+  /// a symbol. names are indices into the name records, the relocations of a
+  /// symbol are relocs[reloc, reloc + num_relocs).
+  /// </summary>
+  struct sym_rec_t {
+    std::uint64_t offset;
+    std::uint64_t data;
+    std::uint32_t size;
+    std::uint32_t name;
+    std::uint32_t scn_name;
+    std::uint32_t type;
+    std::uint32_t scn_chars;
+    std::uint32_t reloc;
+    std::uint32_t num_relocs;
+    std::uint32_t reserved;
+  };
+
+  /// <summary>
+  /// a relocation. name is an index into the name records.
+  /// </summary>
+  struct reloc_rec_t {
+    std::uint32_t offset;
+    std::uint32_t name;
+  };
+
+  /// <summary>
+  /// a name, the text is strs[offset, offset + size).
+  /// </summary>
+  struct name_rec_t {
+    std::uint32_t offset;
+    std::uint32_t size;
+  };
+
+  static constexpr std::uint32_t magic = 0x42544854;  // "THTB"
+  static constexpr std::uint32_t version = 1;
+
+  std::unique_ptr<decomp::file_map_t> m_map;
+};
+}  // namespace theo::recomp
@@ -0,0 +1,116 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <obf/transform/operation.hpp>
+
+namespace theo::recomp {
+/// <summary>
+/// a transformation applied to a relocation and the immediate value passed to
+/// it.
+/// </summary>
+using transform_entry_t =
+    std::pair<obf::transform::transform_t*, std::uint32_t>;
+
+/// <summary>
+/// singleton pool of relocation transformation chains. a chain is stored
+/// contiguously and relocations refer to it by (index, length), so a
+/// relocation stays a small trivially copyable value.
+///
+/// adding chains is thread safe. reading a chain is lock free, the storage of a
+/// chain never moves.
+///
+/// a chain is owned by the one relocation it was added for. it is released
+/// when the relocation is given another chain or its symbol leaves the symbol
+/// table, and its storage is reused by the next chain of the same length, so
+/// the pool holds about as many transformations as the relocations that are
+/// alive.
+/// </summary>
+class transform_pool_t {
+  explicit transform_pool_t() : m_size(0), m_used(0) {}
+
+ public:
+  /// <summary>
+  /// get the singleton object of this class.
+  /// </summary>
+  /// <returns>the singleton object of this class.</returns>
+  static transform_pool_t* get();
+
+  /// <summary>
+  /// adds a chain of transformations to the pool.
+  /// </summary>
+  /// <param name="chain">the transformations in the order they are
+  /// applied.</param>
+  /// <returns>the index of the first transformation of the chain.</returns>
+  std::uint32_t add(std::span<const transform_entry_t> chain);
+
+  /// <summary>
+  /// gets a chain of transformations.
+  /// </summary>
+  /// <param name="idx">the index returned by add.</param>
+  /// <param name="len">the number of transformations in the chain.</param>
+  /// <returns>the transformations of the chain.</returns>
+  std::span<const transform_entry_t> chain(std::uint32_t idx,
+                                           std::uint32_t len) const;
+
+  /// <summary>
+  /// gives the storage of a chain back to the pool. the chain must not be read
+  /// afterwards.
+  /// </summary>
+  /// <param name="idx">the index returned by add.</param>
+  /// <param name="len">the number of transformations in the chain.</param>
+  void release(std::uint32_t idx, std::uint32_t len);
+
+  /// <summary>
+  /// gets the number of transformations in chains that were not released.
+  /// </summary>
+  /// <returns>the number of transformations in use.</returns>
+  std::size_t size();
+
+  static constexpr std::size_t chunk_size = 0x1000;
+
+ private:
+  static constexpr std::size_t max_chunks = 0x10000;
+
+  std::mutex m_mtx;
+  std::array<std::unique_ptr<transform_entry_t[]>, max_chunks> m_chunks;
+  std::uint32_t m_size;
+  std::size_t m_used;
+  std::vector<std::vector<std::uint32_t>> m_free;
+};
+}  // namespace theo::recomp
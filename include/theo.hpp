@@ -34,12 +34,18 @@
 #include <obf/engine.hpp>
 #include <recomp/recomp.hpp>
 #include <recomp/symbol_table.hpp>
+#include <recomp/table_file.hpp>
+#include <util/stats.hpp>
 
 #include <obf/passes/jcc_rewrite_pass.hpp>
 #include <obf/passes/next_inst_pass.hpp>
 #include <obf/passes/reloc_transform_pass.hpp>
 
+#include <filesystem>
+#include <istream>
+#include <memory>
 #include <optional>
+#include <span>
 #include <tuple>
 #include <vector>
 
@@ -70,16 +76,58 @@ using lnk_fns_t =
 class theo_t {
  public:
   /// <summary>
-  /// explicit constructor for theo class.
+  /// explicit constructor for theo class. the lib is borrowed, not copied, so
+  /// the bytes must outlive the theo object.
   /// </summary>
-  /// <param name="lib">a vector of bytes consisting of a lib</param>
+  /// <param name="lib">a span of bytes consisting of a lib</param>
   /// <param name="lnkr_fns"></param>
   /// <param name="entry_sym">the name of the function which will be used as the
   /// entry point</param>
-  explicit theo_t(std::vector<std::uint8_t>& lib,
+  explicit theo_t(std::span<const std::uint8_t> lib,
                   lnk_fns_t lnkr_fns,
                   const std::string&& entry_sym);
 
+  /// <summary>
+  /// explicit constructor for theo class. the lib file is memory mapped read
+  /// only for the lifetime of the theo object.
+  /// </summary>
+  /// <param name="lib">path to the lib file</param>
+  /// <param name="lnkr_fns"></param>
+  /// <param name="entry_sym">the name of the function which will be used as the
+  /// entry point</param>
+  explicit theo_t(const std::filesystem::path& lib,
+                  lnk_fns_t lnkr_fns,
+                  const std::string&& entry_sym);
+
+  /// <summary>
+  /// explicit constructor for theo class. the lib is read from a stream, such
+  /// as a pipe, when decompose is called. the stream must outlive the call.
+  /// </summary>
+  /// <param name="lib">stream positioned at the start of the lib</param>
+  /// <param name="lnkr_fns"></param>
+  /// <param name="entry_sym">the name of the function which will be used as the
+  /// entry point</param>
+  explicit theo_t(std::istream& lib,
+                  lnk_fns_t lnkr_fns,
+                  const std::string&& entry_sym);
+
+  /// <summary>
+  /// sets a directory in which decomposed symbol tables are cached. decompose
+  /// loads the table of the lib and entry point from the directory if there is
+  /// one, otherwise it saves the table after decomposing. libs read from a
+  /// stream are never cached.
+  /// </summary>
+  /// <param name="dir">the cache directory. it must exist.</param>
+  void cache(const std::filesystem::path& dir);
+
+  /// <summary>
+  /// sets the maximum number of threads used to decompose the lib. the
+  /// threads used by the passes are set on obf::engine_t.
+  /// </summary>
+  /// <param name="threads">the maximum number of threads, one disables
+  /// threading.</param>
+  void threads(std::uint32_t threads);
+
   /// <summary>
   /// decomposes the lib file and return the number of symbols that are used.
   /// </summary>
@@ -87,9 +135,30 @@ class theo_t {
   /// decomposition fails.</returns>
   std::optional<std::uint32_t> decompose();
 
+  /// <summary>
+  /// decomposes a new version of the lib file. only the objs that changed
+  /// since the last decompose are decomposed again, and compose only runs the
+  /// obfuscation passes on the symbols that were added. the lib must not have
+  /// been loaded from the cache or read from a stream.
+  /// </summary>
+  /// <param name="lib">path to the new lib file</param>
+  /// <returns>optional amount of symbols that are used. no value if
+  /// decomposition fails.</returns>
+  std::optional<std::uint32_t> redecompose(const std::filesystem::path& lib);
+
+  /// <summary>
+  /// decomposes a new version of the lib. see the path overload.
+  /// </summary>
+  /// <param name="lib">span of bytes of the new lib file. it must outlive the
+  /// theo object.</param>
+  /// <returns>optional amount of symbols that are used. no value if
+  /// decomposition fails.</returns>
+  std::optional<std::uint32_t> redecompose(std::span<const std::uint8_t> lib);
+
   /// <summary>
   /// compose the decomposed module. This will run obfuscation passes, the map
-  /// and resolve symbols to each other.
+  /// and resolve symbols to each other. passes only run on the symbols added
+  /// since the last compose.
   /// </summary>
   /// <returns>returns the address of the entry point symbol</returns>
   std::uintptr_t compose();
@@ -101,10 +170,22 @@ class theo_t {
   /// <returns>the address of the symbol</returns>
   std::uintptr_t resolve(const std::string&& sym);
 
+  /// <summary>
+  /// gets the stats of the last decompose and the redecompose and compose
+  /// calls since. there is a stat for every stage of the pipeline and for
+  /// every pass of every run of the obfuscation engine.
+  /// </summary>
+  /// <returns>the stats, write_trace writes them as a chrome trace.</returns>
+  const util::stats_t& stats() const;
+
  private:
   std::string m_entry_sym;
   decomp::decomp_t m_dcmp;
   recomp::recomp_t m_recmp;
+  std::filesystem::path m_cache_dir;
+  std::unique_ptr<recomp::table_file_t> m_tbl_file;
   recomp::symbol_table_t m_sym_tbl;
+  std::uint32_t m_composed;
+  util::stats_t m_stats;
 };
 }  // namespace theo
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/// <summary>
+/// this namespace contains utilities shared by decomp, obf, and recomp.
+/// </summary>
+namespace theo::util {
+/// <summary>
+/// gets the number of hardware threads. never returns zero.
+/// </summary>
+/// <returns>the number of hardware threads.</returns>
+std::uint32_t hardware_threads();
+
+/// <summary>
+/// invokes the callback once for every index in [0, count). each worker thread
+/// starts with an equal, contiguous range of the indices and works through it
+/// in order. a worker that runs out steals the back half of the largest range
+/// left, so uneven work is balanced without every index being fought over. if
+/// threads is one or less, the callback is invoked in order on the calling
+/// thread. count must fit in 32 bits.
+///
+/// the calling thread is one of the workers, the others are threads of a pool
+/// that is started on first use and kept for the life of the process, so no
+/// thread is created or joined per call. the pool runs one parallel_for at a
+/// time, a call made while it is busy (from inside of the callback or from
+/// another thread) runs on the calling thread alone.
+/// </summary>
+/// <param name="count">the number of indices.</param>
+/// <param name="threads">the maximum number of threads to use.</param>
+/// <param name="fn">callback invoked with each index.</param>
+void parallel_for(std::size_t count,
+                  std::uint32_t threads,
+                  const std::function<void(std::size_t)>& fn);
+}  // namespace theo::util
@@ -0,0 +1,64 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+namespace theo::util {
+/// <summary>
+/// finds an index in storage made of segments that never move, where the first
+/// segment holds base elements and every segment after it holds twice as many
+/// as the one before. the directory of such storage stays small (32 segments
+/// hold more than 2^32 elements for any base) so it can be a fixed array that
+/// readers index without a lock.
+/// </summary>
+/// <param name="idx">the index of the element.</param>
+/// <param name="base">the number of elements in the first segment, a power of
+/// two.</param>
+/// <returns>the segment of the element and its index inside of the
+/// segment.</returns>
+constexpr std::pair<std::size_t, std::size_t> segment_of(std::size_t idx,
+                                                         std::size_t base) {
+  auto seg = std::bit_width(idx / base + 1) - 1;
+  return {seg, idx - base * ((std::size_t{1} << seg) - 1)};
+}
+
+/// <summary>
+/// gets the number of elements in a segment, see segment_of.
+/// </summary>
+/// <param name="seg">the segment.</param>
+/// <param name="base">the number of elements in the first segment.</param>
+/// <returns>the number of elements in the segment.</returns>
+constexpr std::size_t segment_size(std::size_t seg, std::size_t base) {
+  return base << seg;
+}
+}  // namespace theo::util
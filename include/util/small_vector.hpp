@@ -0,0 +1,262 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace theo::util {
+/// <summary>
+/// a vector that stores up to N elements inline and only allocates when it
+/// grows past that. instruction symbols are tiny and there are millions of
+/// them, this keeps their bytes and relocations out of the heap.
+///
+/// the interface is the subset of std::vector that theo uses.
+/// </summary>
+/// <typeparam name="T">the type of the elements.</typeparam>
+/// <typeparam name="N">the number of elements stored inline.</typeparam>
+template <class T, std::size_t N>
+class small_vector {
+  static_assert(N > 0, "small_vector needs at least one inline element");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  small_vector() : m_ptr(inline_ptr()), m_size(0), m_cap(N) {}
+
+  explicit small_vector(size_type count, const T& value = T())
+      : small_vector() {
+    resize(count, value);
+  }
+
+  template <class It,
+            class = typename std::iterator_traits<It>::iterator_category>
+  small_vector(It first, It last) : small_vector() {
+    insert(end(), first, last);
+  }
+
+  small_vector(std::initializer_list<T> init)
+      : small_vector(init.begin(), init.end()) {}
+
+  small_vector(const small_vector& other)
+      : small_vector(other.begin(), other.end()) {}
+
+  small_vector(small_vector&& other) noexcept : small_vector() {
+    take(std::move(other));
+  }
+
+  ~small_vector() { release(); }
+
+  small_vector& operator=(const small_vector& other) {
+    if (this != &other)
+      assign(other.begin(), other.end());
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& other) noexcept {
+    if (this != &other) {
+      release();
+      m_ptr = inline_ptr();
+      m_size = 0;
+      m_cap = N;
+      take(std::move(other));
+    }
+    return *this;
+  }
+
+  T* data() { return m_ptr; }
+  const T* data() const { return m_ptr; }
+  size_type size() const { return m_size; }
+  size_type capacity() const { return m_cap; }
+  bool empty() const { return !m_size; }
+
+  iterator begin() { return m_ptr; }
+  iterator end() { return m_ptr + m_size; }
+  const_iterator begin() const { return m_ptr; }
+  const_iterator end() const { return m_ptr + m_size; }
+
+  T& operator[](size_type idx) { return m_ptr[idx]; }
+  const T& operator[](size_type idx) const { return m_ptr[idx]; }
+  T& front() { return m_ptr[0]; }
+  T& back() { return m_ptr[m_size - 1]; }
+
+  void reserve(size_type cap) {
+    if (cap > m_cap)
+      regrow(cap, m_size, 0, [](T*) {});
+  }
+
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    // the arguments may refer to elements of this vector...
+    //
+    if (m_size == m_cap) {
+      regrow(m_cap * 2, m_size, 1,
+             [&](T* gap) { new (gap) T(std::forward<Args>(args)...); });
+      return back();
+    }
+
+    auto res = new (m_ptr + m_size) T(std::forward<Args>(args)...);
+    ++m_size;
+    return *res;
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void pop_back() { std::destroy_at(m_ptr + --m_size); }
+
+  void resize(size_type count, const T& value = T()) {
+    if (count < m_size) {
+      std::destroy(begin() + count, end());
+      m_size = count;
+      return;
+    }
+
+    // value may be an element of this vector...
+    //
+    if (count > m_cap) {
+      regrow(std::max(count, m_cap * 2), m_size, count - m_size, [&](T* gap) {
+        std::uninitialized_fill_n(gap, count - m_size, value);
+      });
+      return;
+    }
+
+    std::uninitialized_fill(end(), begin() + count, value);
+    m_size = count;
+  }
+
+  void clear() {
+    std::destroy(begin(), end());
+    m_size = 0;
+  }
+
+  // unlike insert, the range must not be inside of this vector...
+  //
+  template <class It>
+  void assign(It first, It last) {
+    clear();
+    insert(end(), first, last);
+  }
+
+  template <class It>
+  iterator insert(const_iterator pos, It first, It last) {
+    // append the new elements then rotate them into place...
+    //
+    auto offset = pos - begin();
+    auto old_size = m_size;
+    auto count = static_cast<size_type>(std::distance(first, last));
+
+    // the range may be inside of this vector, so it is copied into the new
+    // buffer before the old one is freed...
+    //
+    if (m_size + count > m_cap) {
+      regrow(std::max(m_size + count, m_cap * 2), offset, count,
+             [&](T* gap) { std::uninitialized_copy(first, last, gap); });
+      return begin() + offset;
+    }
+
+    std::uninitialized_copy(first, last, end());
+    m_size += count;
+    std::rotate(begin() + offset, begin() + old_size, end());
+    return begin() + offset;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto bgn = begin() + (first - begin());
+    auto res = std::move(begin() + (last - begin()), end(), bgn);
+    std::destroy(res, end());
+    m_size = res - begin();
+    return bgn;
+  }
+
+ private:
+  T* inline_ptr() { return reinterpret_cast<T*>(m_inline); }
+  bool is_inline() const {
+    return m_ptr == reinterpret_cast<const T*>(m_inline);
+  }
+
+  // moves the elements into a new buffer of cap elements, leaving gap elements
+  // at offset for fill to construct. fill runs before the elements are moved
+  // out of the old buffer, so it may read them...
+  //
+  template <class Fn>
+  void regrow(size_type cap, size_type offset, size_type gap, Fn fill) {
+    auto ptr = static_cast<T*>(::operator new(cap * sizeof(T)));
+    fill(ptr + offset);
+    std::uninitialized_move(begin(), begin() + offset, ptr);
+    std::uninitialized_move(begin() + offset, end(), ptr + offset + gap);
+
+    auto size = m_size + gap;
+    release();
+    m_ptr = ptr;
+    m_size = size;
+    m_cap = cap;
+  }
+
+  // steals the heap buffer of other, or moves its inline elements...
+  //
+  void take(small_vector&& other) {
+    if (other.is_inline()) {
+      std::uninitialized_move(other.begin(), other.end(), begin());
+      m_size = other.m_size;
+      other.clear();
+      return;
+    }
+
+    m_ptr = other.m_ptr;
+    m_size = other.m_size;
+    m_cap = other.m_cap;
+    other.m_ptr = other.inline_ptr();
+    other.m_size = 0;
+    other.m_cap = N;
+  }
+
+  void release() {
+    std::destroy(begin(), end());
+    if (!is_inline())
+      ::operator delete(m_ptr);
+  }
+
+  alignas(T) std::byte m_inline[N * sizeof(T)];
+  T* m_ptr;
+  size_type m_size;
+  size_type m_cap;
+};
+}  // namespace theo::util
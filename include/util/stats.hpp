@@ -0,0 +1,128 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace theo::util {
+/// <summary>
+/// what was measured for a stage of the pipeline or for a pass.
+/// </summary>
+struct stat_t {
+  /// <summary>
+  /// the name of the stage or of the pass.
+  /// </summary>
+  std::string name;
+
+  /// <summary>
+  /// the track the stat is shown on in a trace. the stages of the pipeline
+  /// are on track zero, every pass has a track of its own.
+  /// </summary>
+  std::uint32_t track;
+
+  /// <summary>
+  /// when the stage or pass started, in nanoseconds since the stats were
+  /// cleared.
+  /// </summary>
+  std::uint64_t bgn_ns;
+
+  /// <summary>
+  /// the wall time of the stage or pass. for a pass, from the start of the
+  /// first batch it ran on to the end of the last one.
+  /// </summary>
+  std::uint64_t time_ns;
+
+  /// <summary>
+  /// the symbols passed to the stage or pass, the symbols it added to the
+  /// symbol table, and the bytes and relocations it added to symbols.
+  /// </summary>
+  std::uint64_t syms_visited;
+  std::uint64_t syms_created;
+  std::uint64_t bytes_added;
+  std::uint64_t relocs_added;
+
+  /// <summary>
+  /// for a pass, the time spent in the pass summed over the threads that ran
+  /// it. zero for a stage.
+  /// </summary>
+  std::uint64_t cpu_ns = 0;
+};
+
+/// <summary>
+/// collects the stats of decompose and compose. the stats can be written as a
+/// chrome trace event file, which can be opened in chrome://tracing or
+/// https://ui.perfetto.dev.
+/// </summary>
+class stats_t {
+ public:
+  explicit stats_t();
+
+  /// <summary>
+  /// removes every stat and restarts the clock.
+  /// </summary>
+  void clear();
+
+  /// <summary>
+  /// gets the time since the stats were cleared.
+  /// </summary>
+  /// <returns>the time since the stats were cleared in
+  /// nanoseconds.</returns>
+  std::uint64_t now() const;
+
+  /// <summary>
+  /// adds a stat. this is thread safe.
+  /// </summary>
+  /// <param name="stat">the stat to add.</param>
+  void add(stat_t stat);
+
+  /// <summary>
+  /// gets every stat in the order they were added. not thread safe with add.
+  /// </summary>
+  /// <returns>every stat in the order they were added.</returns>
+  const std::vector<stat_t>& all() const;
+
+  /// <summary>
+  /// writes the stats as a chrome trace event json file.
+  /// </summary>
+  /// <param name="path">path of the file to write.</param>
+  /// <returns>true if the file was written.</returns>
+  bool write_trace(const std::filesystem::path& path) const;
+
+ private:
+  std::chrono::steady_clock::time_point m_epoch;
+  std::mutex m_mtx;
+  std::vector<stat_t> m_stats;
+};
+}  // namespace theo::util
@@ -0,0 +1,120 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <decomp/ar_stream.hpp>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <charconv>
+
+namespace theo::decomp {
+namespace {
+constexpr std::size_t ar_name_length = 16;
+}  // namespace
+
+ar_stream_t::ar_stream_t(std::istream& in) : m_in(in), m_valid(false) {
+  std::array<char, ar_magic.size()> magic = {};
+  m_in.read(magic.data(), magic.size());
+  m_valid = m_in.gcount() == magic.size() &&
+            std::string_view(magic.data(), magic.size()) == ar_magic;
+
+  if (!m_valid)
+    spdlog::error("stream is not a lib file...");
+}
+
+bool ar_stream_t::valid() const {
+  return m_valid;
+}
+
+std::optional<ar_member_t> ar_stream_t::next() {
+  while (m_valid) {
+    std::array<std::uint8_t, ar_hdr_size> hdr = {};
+    m_in.read(reinterpret_cast<char*>(hdr.data()), hdr.size());
+    if (m_in.gcount() != hdr.size())
+      return {};
+
+    auto size = ar_member_size(hdr.data());
+    if (!size.has_value()) {
+      spdlog::error("invalid archive member header in stream...");
+      m_valid = false;
+      return {};
+    }
+
+    ar_member_t res;
+    res.data.resize(size.value());
+    m_in.read(reinterpret_cast<char*>(res.data.data()), res.data.size());
+    if (m_in.gcount() != res.data.size()) {
+      spdlog::error("lib stream is truncated...");
+      m_valid = false;
+      return {};
+    }
+
+    // members are aligned to two bytes. the last member may not be padded...
+    //
+    if (size.value() & 1)
+      m_in.ignore(1);
+
+    std::string_view field(reinterpret_cast<const char*>(hdr.data()),
+                           ar_name_length);
+
+    // skip the linker members, keep the long names for naming the objs...
+    //
+    if (field.starts_with("/ "))
+      continue;
+
+    if (field.starts_with("//")) {
+      m_long_names.assign(res.data.begin(), res.data.end());
+      continue;
+    }
+
+    res.name = member_name(field);
+    return res;
+  }
+
+  return {};
+}
+
+std::string ar_stream_t::member_name(std::string_view field) {
+  // long names are of the format /offset into the long names member...
+  //
+  std::size_t offset = {};
+  auto [ptr, ec] =
+      std::from_chars(field.data() + 1, field.data() + field.size(), offset);
+
+  if (field.starts_with("/") && ec == std::errc() &&
+      offset < m_long_names.size()) {
+    auto name = std::string_view(m_long_names).substr(offset);
+    return std::string(
+        name.substr(0, name.find_first_of(std::string_view("/\n\0", 3))));
+  }
+
+  return std::string(field.substr(0, field.find_first_of("/ ")));
+}
+}  // namespace theo::decomp
@@ -0,0 +1,203 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <decomp/archive_idx.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace theo::decomp {
+namespace {
+constexpr std::size_t ar_size_offset = 48;
+constexpr std::size_t ar_size_length = 10;
+
+std::uint32_t read_be32(const std::uint8_t* p) {
+  return (static_cast<std::uint32_t>(p[0]) << 24) |
+         (static_cast<std::uint32_t>(p[1]) << 16) |
+         (static_cast<std::uint32_t>(p[2]) << 8) | p[3];
+}
+
+template <class T>
+T read_le(const std::uint8_t* p) {
+  T res;
+  std::memcpy(&res, p, sizeof res);
+  return res;
+}
+
+// reads the next null terminated name inside of [pos, end). returns false if
+// the name is not terminated...
+//
+bool read_name(const std::uint8_t*& pos,
+               const std::uint8_t* end,
+               std::string_view& name) {
+  auto term = std::find(pos, end, 0);
+  if (term == end)
+    return false;
+
+  name = {reinterpret_cast<const char*>(pos),
+          static_cast<std::size_t>(term - pos)};
+  pos = term + 1;
+  return true;
+}
+}  // namespace
+
+std::optional<std::size_t> ar_member_size(const std::uint8_t* hdr) {
+  // the size is an ascii decimal number padded with spaces...
+  //
+  auto size_bgn = reinterpret_cast<const char*>(hdr + ar_size_offset);
+
+  std::size_t size = {};
+  auto [ptr, ec] = std::from_chars(size_bgn, size_bgn + ar_size_length, size);
+  if (ec != std::errc())
+    return {};
+
+  return size;
+}
+
+archive_idx_t::archive_idx_t(std::span<const std::uint8_t> lib)
+    : m_lib(lib), m_valid(false) {
+  if (lib.size() < ar_magic.size() ||
+      std::memcmp(lib.data(), ar_magic.data(), ar_magic.size()))
+    return;
+
+  // the linker members come first, optionally followed by the long names
+  // member. stop at the first obj...
+  //
+  std::vector<std::span<const std::uint8_t>> lnk_members;
+  for (std::size_t offset = ar_magic.size(); offset + ar_hdr_size <= lib.size();
+       offset += ar_hdr_size + ((member(offset).size() + 1) & ~1ull)) {
+    auto hdr = reinterpret_cast<const char*>(lib.data() + offset);
+    if (hdr[0] != '/')
+      break;
+
+    if (hdr[1] == ' ')
+      lnk_members.push_back(member(offset));
+    else if (hdr[1] != '/')
+      break;
+  }
+
+  if (lnk_members.size() >= 2)
+    m_valid = parse_second(lnk_members[1]);
+  else if (lnk_members.size() == 1)
+    m_valid = parse_first(lnk_members[0]);
+
+  if (!m_valid)
+    spdlog::warn("lib has no usable linker member...");
+}
+
+bool archive_idx_t::valid() const {
+  return m_valid;
+}
+
+std::vector<std::uint32_t> archive_idx_t::members(std::string_view sym) const {
+  std::vector<std::uint32_t> res;
+  auto [bgn, end] = m_syms.equal_range(sym);
+  for (auto itr = bgn; itr != end; ++itr)
+    res.push_back(itr->second);
+
+  std::sort(res.begin(), res.end());
+  res.erase(std::unique(res.begin(), res.end()), res.end());
+  return res;
+}
+
+std::span<const std::uint8_t> archive_idx_t::member(
+    std::uint32_t offset) const {
+  if (offset + ar_hdr_size > m_lib.size())
+    return {};
+
+  auto size = ar_member_size(m_lib.data() + offset);
+  if (!size.has_value() || offset + ar_hdr_size + size.value() > m_lib.size())
+    return {};
+
+  return m_lib.subspan(offset + ar_hdr_size, size.value());
+}
+
+bool archive_idx_t::parse_first(std::span<const std::uint8_t> data) {
+  if (data.size() < sizeof(std::uint32_t))
+    return false;
+
+  auto num_syms = read_be32(data.data());
+  auto offsets = data.data() + sizeof(std::uint32_t);
+  auto names = offsets + std::size_t(num_syms) * sizeof(std::uint32_t);
+  if (names > data.data() + data.size())
+    return false;
+
+  auto end = data.data() + data.size();
+  for (auto idx = 0u; idx < num_syms; ++idx) {
+    std::string_view name;
+    if (!read_name(names, end, name))
+      return false;
+
+    m_syms.emplace(name, read_be32(offsets + idx * sizeof(std::uint32_t)));
+  }
+
+  return true;
+}
+
+bool archive_idx_t::parse_second(std::span<const std::uint8_t> data) {
+  if (data.size() < sizeof(std::uint32_t))
+    return false;
+
+  auto pos = data.data();
+  auto end = data.data() + data.size();
+  auto num_members = read_le<std::uint32_t>(pos);
+  auto offsets = pos + sizeof(std::uint32_t);
+  pos = offsets + std::size_t(num_members) * sizeof(std::uint32_t);
+  if (pos + sizeof(std::uint32_t) > end)
+    return false;
+
+  auto num_syms = read_le<std::uint32_t>(pos);
+  auto indices = pos + sizeof(std::uint32_t);
+  auto names = indices + std::size_t(num_syms) * sizeof(std::uint16_t);
+  if (names > end)
+    return false;
+
+  for (auto idx = 0u; idx < num_syms; ++idx) {
+    std::string_view name;
+    if (!read_name(names, end, name))
+      return false;
+
+    // member indices are one based...
+    //
+    auto member_idx =
+        read_le<std::uint16_t>(indices + idx * sizeof(std::uint16_t));
+
+    if (!member_idx || member_idx > num_members)
+      return false;
+
+    auto offset = offsets + (member_idx - 1) * sizeof(std::uint32_t);
+    m_syms.emplace(name, read_le<std::uint32_t>(offset));
+  }
+
+  return true;
+}
+}  // namespace theo::decomp
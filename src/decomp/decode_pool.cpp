@@ -0,0 +1,115 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <decomp/decode_pool.hpp>
+#include <cassert>
+
+namespace theo::decomp {
+decode_pool_t* decode_pool_t::get() {
+  static decode_pool_t obj;
+  return &obj;
+}
+
+std::uint32_t decode_pool_t::acquire() {
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  // reuse a released slot...
+  //
+  if (!m_free.empty()) {
+    auto idx = m_free.back();
+    m_free.pop_back();
+    return idx;
+  }
+
+  // slots are numbered from one so that zero means no slot...
+  //
+  if (m_size == chunk_size * max_chunks)
+    return 0;
+
+  auto& chunk = m_chunks[m_size / chunk_size];
+  if (!chunk)
+    chunk = std::make_unique<xed_decoded_inst_t[]>(chunk_size);
+
+  return ++m_size;
+}
+
+xed_decoded_inst_t* decode_pool_t::at(std::uint32_t idx) const {
+  assert(idx);
+  return &m_chunks[(idx - 1) / chunk_size][(idx - 1) % chunk_size];
+}
+
+void decode_pool_t::release(std::uint32_t idx) {
+  if (!idx)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_mtx);
+  m_free.push_back(idx);
+}
+
+std::size_t decode_pool_t::size() {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  return m_size - m_free.size();
+}
+
+decode_ref_t::~decode_ref_t() {
+  reset();
+}
+
+decode_ref_t::decode_ref_t(decode_ref_t&& other) noexcept
+    : m_idx(other.m_idx) {
+  other.m_idx = 0;
+}
+
+decode_ref_t& decode_ref_t::operator=(decode_ref_t&& other) noexcept {
+  if (this != &other) {
+    reset();
+    m_idx = other.m_idx;
+    other.m_idx = 0;
+  }
+
+  return *this;
+}
+
+xed_decoded_inst_t* decode_ref_t::acquire() {
+  if (!m_idx)
+    m_idx = decode_pool_t::get()->acquire();
+
+  return get();
+}
+
+xed_decoded_inst_t* decode_ref_t::get() const {
+  return m_idx ? decode_pool_t::get()->at(m_idx) : nullptr;
+}
+
+void decode_ref_t::reset() {
+  decode_pool_t::get()->release(m_idx);
+  m_idx = 0;
+}
+}  // namespace theo::decomp
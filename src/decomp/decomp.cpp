@@ -31,265 +31,899 @@
 #include <decomp/decomp.hpp>
 
 namespace theo::decomp {
-decomp_t::decomp_t(std::vector<std::uint8_t>& lib, recomp::symbol_table_t* syms)
-    : m_lib(lib), m_syms(syms) {}
+namespace {
+// objs read from a stream are held back up to this many bytes by default...
+//
+constexpr std::size_t default_retain_limit = 64 * 1024 * 1024;
+
+// coff images are read in place, so an obj must be aligned for the coff
+// structures. members of an archive are only aligned to two bytes...
+//
+constexpr std::size_t obj_align =
+    std::max({alignof(coff::image_t), alignof(coff::section_header_t),
+              alignof(coff::symbol_t), alignof(coff::reloc_t)});
+}  // namespace
+
+decomp_t::decomp_t(std::span<const std::uint8_t> lib,
+                   recomp::symbol_table_t* syms)
+    : m_lib(lib),
+      m_stream(nullptr),
+      m_retain_limit(default_retain_limit),
+      m_syms(syms),
+      m_threads(util::hardware_threads()) {}
+
+decomp_t::decomp_t(const std::filesystem::path& lib,
+                   recomp::symbol_table_t* syms)
+    : m_map(std::make_unique<file_map_t>(lib)),
+      m_lib(m_map->data()),
+      m_stream(nullptr),
+      m_retain_limit(default_retain_limit),
+      m_syms(syms),
+      m_threads(util::hardware_threads()) {}
+
+decomp_t::decomp_t(std::istream& lib, recomp::symbol_table_t* syms)
+    : m_stream(&lib),
+      m_retain_limit(default_retain_limit),
+      m_syms(syms),
+      m_threads(util::hardware_threads()) {}
+
+void decomp_t::threads(std::uint32_t threads) {
+  m_threads = threads;
+}
+
+void decomp_t::retain_limit(std::size_t bytes) {
+  m_retain_limit = bytes;
+}
 
 std::optional<recomp::symbol_table_t*> decomp_t::decompose(
     std::string& entry_sym) {
-  // extract obj files from the archive file...
+  auto entry = name_pool_t::get()->intern(entry_sym);
+
+  if (m_stream) {
+    if (!stream_objs(entry)) {
+      spdlog::error("failed to read lib from stream...");
+      return {};
+    }
+  } else if (m_lib.empty()) {
+    spdlog::error("lib is empty or failed to map...");
+    return {};
+  } else {
+    // if the lib has a linker member then objs are loaded when a symbol they
+    // define is needed. otherwise every obj is extracted from the archive up
+    // front. the objs are views into the lib, nothing is copied...
+    //
+    m_ar_idx = std::make_unique<archive_idx_t>(m_lib);
+  }
+
+  if (m_ar_idx && !m_ar_idx->valid()) {
+    std::vector<std::span<const std::uint8_t>> objs;
+    ar::view<false> lib(m_lib.data(), m_lib.size());
+    std::for_each(
+        lib.begin(), lib.end(),
+        [&](std::pair<std::string_view, ar::entry_t&> itr) {
+          // if the entry isnt the symbol table or the string table
+          // then we know its an obj file...
+          //
+          if (!itr.second.is_symbol_table() && !itr.second.is_string_table()) {
+            spdlog::info("extracted obj from archive: {}", itr.first);
+            objs.emplace_back(itr.second.begin(), itr.second.end());
+          }
+        });
+
+    load_objs(objs);
+  }
+
+  // extract used symbols from objs and create a nice little set of them so that
+  // we can easily decompose them... no need deal with every single symbol...
+  spdlog::info("extracted {} symbols being used...",
+               ext_used_syms(entry));
+
+  if (!decompose_used({m_used_syms.begin(), m_used_syms.end()}))
+    return {};
+
+  // return the extract symbols to the caller...
+  //
+  return m_syms;
+}
+
+std::optional<recomp::symbol_table_t*> decomp_t::redecompose(
+    std::span<const std::uint8_t> lib,
+    std::string& entry_sym) {
+  if (m_stream || m_used_syms.empty()) {
+    spdlog::error(
+        "redecompose needs a lib decomposed from memory or a file...");
+    return {};
+  }
+
+  if (lib.empty()) {
+    spdlog::error("lib is empty or failed to map...");
+    return {};
+  }
+
+  // the symbols of unchanged objs keep pointing into the previous lib...
+  //
+  if (m_map)
+    m_old_maps.push_back(std::move(m_map));
+
+  m_lib = lib;
+  if (!update_objs(name_pool_t::get()->intern(entry_sym)))
+    return {};
+
+  return m_syms;
+}
+
+std::optional<recomp::symbol_table_t*> decomp_t::redecompose(
+    const std::filesystem::path& lib,
+    std::string& entry_sym) {
+  if (m_stream || m_used_syms.empty()) {
+    spdlog::error(
+        "redecompose needs a lib decomposed from memory or a file...");
+    return {};
+  }
+
+  auto map = std::make_unique<file_map_t>(lib);
+  if (map->data().empty()) {
+    spdlog::error("lib is empty or failed to map...");
+    return {};
+  }
+
+  if (m_map)
+    m_old_maps.push_back(std::move(m_map));
+
+  m_map = std::move(map);
+  m_lib = m_map->data();
+  if (!update_objs(name_pool_t::get()->intern(entry_sym)))
+    return {};
+
+  return m_syms;
+}
+
+bool decomp_t::update_objs(name_id_t entry_sym) {
+  m_ar_idx = std::make_unique<archive_idx_t>(m_lib);
+  m_loaded_members.clear();
+
+  // a lib may hold several members with the same bytes, each loaded obj
+  // stands in for one of them...
+  //
+  std::unordered_map<std::uint64_t, std::vector<const coff::image_t*>> loaded;
+  for (auto& [img, hash] : m_obj_hashes)
+    loaded[hash].push_back(img);
+
+  // a member with the same bytes as a loaded obj is unchanged, the loaded obj
+  // stands in for it. the other members are new or changed, they are loaded
+  // on demand through the linker member like in decompose...
   //
+  std::unordered_set<const coff::image_t*> kept;
+  std::vector<std::span<const std::uint8_t>> objs;
   ar::view<false> lib(m_lib.data(), m_lib.size());
   std::for_each(
       lib.begin(), lib.end(),
       [&](std::pair<std::string_view, ar::entry_t&> itr) {
-        // if the entry isnt the symbol table or the string table
-        // then we know its an obj file...
-        //
-        if (!itr.second.is_symbol_table() && !itr.second.is_string_table()) {
-          spdlog::info("extracted obj from archive: {}", itr.first);
-          std::vector<std::uint8_t> data(itr.second.begin(), itr.second.end());
-          m_objs.push_back(data);
+        if (itr.second.is_symbol_table() || itr.second.is_string_table())
+          return;
+
+        std::span<const std::uint8_t> obj(itr.second.begin(),
+                                          itr.second.end());
+        auto res = loaded.find(util::hash64(
+            {reinterpret_cast<const char*>(obj.data()), obj.size()}));
+
+        if (res != loaded.end() && !res->second.empty()) {
+          kept.insert(res->second.back());
+          res->second.pop_back();
+          m_loaded_members.insert(obj.data() - ar_hdr_size - m_lib.data());
+        } else if (!m_ar_idx->valid()) {
+          objs.push_back(obj);
         }
       });
 
-  std::for_each(
-      m_objs.begin(), m_objs.end(), [&](std::vector<std::uint8_t>& img_data) {
-        auto img = reinterpret_cast<coff::image_t*>(img_data.data());
-        for (auto idx = 0u; idx < img->file_header.num_symbols; ++idx) {
-          auto sym = img->get_symbol(idx);
-          if (sym->section_index - 1 > img->file_header.num_sections)
-            continue;
-
-          auto sym_name = symbol_t::name(img, sym);
-          if (sym_name.length()) {
-            auto sym_hash = symbol_t::hash(sym_name.data());
-            auto sym_size =
-                sym->has_section()
-                    ? next_sym(img, img->get_section(sym->section_index - 1),
-                               sym)
-                    : 0u;
-
-            m_lookup_tbl[sym_hash].emplace_back(img, sym, sym_size);
-          }
-        }
-      });
+  std::vector<const coff::image_t*> stale;
+  for (auto& [img, hash] : m_obj_hashes)
+    if (!kept.count(img))
+      stale.push_back(img);
 
-  // extract used symbols from objs and create a nice little set of them so that
-  // we can easily decompose them... no need deal with every single symbol...
-  spdlog::info("extracted {} symbols being used...",
-               ext_used_syms(entry_sym.data()));
+  spdlog::info("{} objs changed or were removed...", stale.size());
+
+  std::vector<name_id_t> lost, dropped;
+  std::unordered_set<const coff::image_t*> stale_imgs(stale.begin(),
+                                                     stale.end());
+  for (auto img : stale)
+    unload_obj(img, lost, dropped);
+
+  if (!objs.empty())
+    load_objs(objs);
 
-  // generate symbols, populate section hash table, for each object file
-  // extracted from the archive file...
+  // symbols of changed objs that are still referenced are looked up again,
+  // the definition may now be in another obj...
   //
-  std::for_each(m_used_syms.begin(), m_used_syms.end(), [&](sym_data_t data) {
+  std::vector<sym_data_t> added;
+  lost.push_back(entry_sym);
+  for (auto name : lost) {
+    if (name != entry_sym && !m_refs[name])
+      continue;
+
+    auto def = get_symbol(name);
+    if (def.has_value() && m_used_syms.emplace(def.value()).second)
+      added.push_back(def.value());
+  }
+
+  mark_used(added);
+
+  // symbols that lost their last reference are no longer used, neither are
+  // the symbols only they referenced...
+  //
+  std::unordered_set<const coff::symbol_t*> unused;
+  while (!dropped.empty()) {
+    auto name = dropped.back();
+    dropped.pop_back();
+    if (name == entry_sym || m_refs[name])
+      continue;
+
+    auto def = find_symbol(name);
+    if (!def.has_value() || !m_used_syms.count(def.value()))
+      continue;
+
+    unuse(def.value(), dropped);
+    unused.insert(std::get<1>(def.value()));
+  }
+
+  // erase the symbols of changed objs and unused symbols, along with the
+  // instruction symbols passes split them into, before the new symbols are
+  // added since they may have the same names...
+  //
+  std::vector<std::size_t> erased;
+  m_syms->for_each([&](symbol_t& sym) {
+    if (stale_imgs.count(sym.img()) || (sym.sym() && unused.count(sym.sym())))
+      erased.push_back(sym.hash());
+  });
+
+  for (auto hash : erased)
+    m_syms->erase(hash);
+
+  std::erase_if(added, [&](sym_data_t data) {
+    return !m_used_syms.count(data);
+  });
+
+  spdlog::info("erased {} symbols, decomposing {} symbols...", erased.size(),
+               added.size());
+
+  // the name pool only grows and the transform pool reuses what erased
+  // symbols released, log both so their growth across rebuilds can be
+  // watched...
+  //
+  spdlog::info("{} names interned, {} reloc transformations in use...",
+               name_pool_t::get()->size(),
+               recomp::transform_pool_t::get()->size());
+
+  return decompose_used(added);
+}
+
+void decomp_t::unload_obj(const coff::image_t* img,
+                          std::vector<name_id_t>& lost,
+                          std::vector<name_id_t>& dropped) {
+  std::vector<sym_data_t> used;
+  for (auto itr = m_used_syms.lower_bound({img, nullptr, 0});
+       itr != m_used_syms.end() && std::get<0>(*itr) == img; ++itr)
+    used.push_back(*itr);
+
+  for (auto data : used) {
+    lost.push_back(sym_name(img, std::get<1>(data) - img->get_symbol(0)));
+    unuse(data, dropped);
+  }
+
+  // remove the symbols of the obj from the lookup table...
+  //
+  auto pool = name_pool_t::get();
+  auto& names = m_sym_names.at(img);
+  std::unordered_set<name_id_t> img_names(names.begin(), names.end());
+  img_names.erase(no_name);
+  for (auto name : img_names) {
+    auto sym_hash = pool->hash(name);
+    auto& shard = m_lookup_tbl[sym_hash % lookup_shards];
+    auto res = shard.find(sym_hash);
+    if (res == shard.end())
+      continue;
+
+    std::erase_if(res->second, [&](const sym_data_t& data) {
+      return std::get<0>(data) == img;
+    });
+
+    if (res->second.empty())
+      shard.erase(res);
+  }
+
+  for (auto idx = 0u; idx < img->file_header.num_sections; ++idx)
+    m_reloc_tbl.erase(img->get_section(idx));
+
+  std::erase_if(m_objs, [&](std::span<const std::uint8_t> obj) {
+    return obj.data() == reinterpret_cast<const std::uint8_t*>(img);
+  });
+
+  m_scn_syms.erase(img);
+  m_sym_names.erase(img);
+  m_obj_hashes.erase(img);
+}
+
+bool decomp_t::decompose_used(const std::vector<sym_data_t>& used) {
+  // symbols are put into the table in the order of the hash of their obj and
+  // their index inside of it. the order of the table is the order passes see
+  // symbols in and the order they are allocated in, so it must not depend on
+  // where the objs are in memory or on which thread finishes first...
+  //
+  const auto sym_key = [&](sym_data_t data) {
+    auto [img, sym, size] = data;
+    return std::make_pair(m_obj_hashes.at(img), sym - img->get_symbol(0));
+  };
+
+  std::vector<sym_data_t> ordered(used.begin(), used.end());
+  std::sort(ordered.begin(), ordered.end(), [&](sym_data_t a, sym_data_t b) {
+    return sym_key(a) < sym_key(b);
+  });
+
+  // allocate the section symbol array of each obj and collect the sections
+  // that need a section symbol. this is done on this thread so that the
+  // symbols can be generated in parallel below...
+  //
+  std::set<std::pair<const coff::image_t*, std::uint32_t>> scns;
+  std::for_each(ordered.begin(), ordered.end(), [&](sym_data_t data) {
     auto [img, sym, size] = data;
+    m_scn_syms.try_emplace(img, img->file_header.num_sections);
 
-    // populate section hash table with sections for the img of this
-    // symbol... only populate the hash table if its not been populated for
-    // this obj before...
+    if (!sym->has_section())
+      return;
+
+    // make sure the relocation index of the section is built, from here on it
+    // is only read...
     //
-    if (m_processed_objs.emplace(img).second) {
-      for (auto idx = 0u; idx < img->file_header.num_sections; ++idx) {
-        auto scn = img->get_section(idx);
-        auto scn_sym_name =
-            std::string(scn->name.to_string(img->get_strings()))
-                .append("#")
-                .append(std::to_string(idx))
-                .append("!")
-                .append(std::to_string(img->file_header.timedate_stamp));
-
-        // hash the name of the section + the index + the timestamp of the
-        // obj file it is in...
-        //
-        m_scn_hash_tbl.insert({scn, decomp::symbol_t::hash(scn_sym_name)});
-      }
-    }
+    scn_relocs(img, img->get_section(sym->section_index - 1));
 
-    // if the symbol is a function then we are going to decompose it...
-    // data symbols are handled after this...
+    // data symbols that are public or private (some data symbols are private)
+    // are allocated inside of a symbol for their section...
     //
-    if (sym->has_section()) {
-      if (sym->derived_type == coff::derived_type_id::function) {
-        auto scn = img->get_section(sym->section_index - 1);
-        auto fn_size = next_sym(img, scn, sym);
-        auto fn_bgn = scn->ptr_raw_data + reinterpret_cast<std::uint8_t*>(img) +
-                      sym->value;
-
-        // extract the bytes the function is composed of...
-        //
-        std::vector<std::uint8_t> fn(fn_bgn, fn_bgn + fn_size);
-        decomp::routine_t rtn(sym, img, scn, fn);
-
-        auto fsym = rtn.decompose();
-        m_syms->put_symbol(fsym);
-        // else the symbol isnt a function and its public or private (some data
-        // symbols are private)...
-      } else if (sym->storage_class == coff::storage_class_id::public_symbol ||
-                 sym->storage_class == coff::storage_class_id::private_symbol) {
-        auto scn = img->get_section(sym->section_index - 1);
-        auto scn_sym = m_syms->sym_from_hash(m_scn_hash_tbl[scn]);
-
-        // if the section containing this symbol doesnt have a symbol then make
-        // one and put it into the symbol table...
-        //
-        if (!scn_sym.has_value()) {
-          auto scn_sym_name =
-              std::string(scn->name.to_string(img->get_strings()))
-                  .append("#")
-                  .append(std::to_string(sym->section_index - 1))
-                  .append("!")
-                  .append(std::to_string(img->file_header.timedate_stamp));
-
-          std::vector<std::uint8_t> scn_data(scn->size_raw_data);
-          if (scn->characteristics.cnt_uninit_data) {
-            scn_data.insert(scn_data.begin(), scn->size_raw_data, 0);
-          } else {
-            scn_data.insert(
-                scn_data.begin(),
-                reinterpret_cast<std::uint8_t*>(img) + scn->ptr_raw_data,
-                reinterpret_cast<std::uint8_t*>(img) + scn->ptr_raw_data +
-                    scn->size_raw_data);
-          }
+    if (sym->derived_type != coff::derived_type_id::function &&
+        (sym->storage_class == coff::storage_class_id::public_symbol ||
+         sym->storage_class == coff::storage_class_id::private_symbol))
+      scns.emplace(img, sym->section_index - 1);
+  });
 
-          // extract the relocations needed for this section...
-          //
-          std::vector<recomp::reloc_t> relocs;
-          auto scn_relocs = reinterpret_cast<coff::reloc_t*>(
-              scn->ptr_relocs + reinterpret_cast<std::uint8_t*>(img));
-
-          for (auto idx = 0u; idx < scn->num_relocs; ++idx) {
-            auto scn_reloc = &scn_relocs[idx];
-            auto sym_reloc = img->get_symbol(scn_relocs[idx].symbol_index);
-            auto sym_name = symbol_t::name(img, sym_reloc);
-            auto sym_hash = decomp::symbol_t::hash(sym_name.data());
-            relocs.push_back(
-                recomp::reloc_t(scn_reloc->virtual_address - sym->value,
-                                sym_hash, sym_name.data()));
-          }
+  // generate a symbol for each section that contains used data symbols and
+  // does not have one yet...
+  //
+  std::vector<std::pair<const coff::image_t*, std::uint32_t>> used_scns;
+  for (auto& [img, scn_idx] : scns)
+    if (!m_scn_syms.at(img)[scn_idx])
+      used_scns.emplace_back(img, scn_idx);
+
+  std::sort(used_scns.begin(), used_scns.end(), [&](auto& a, auto& b) {
+    return std::make_pair(m_obj_hashes.at(a.first), a.second) <
+           std::make_pair(m_obj_hashes.at(b.first), b.second);
+  });
 
-          // create a new section symbol...
-          //
-          decomp::symbol_t new_scn_sym(img, scn_sym_name, 0, scn_data, scn, {},
-                                       relocs, sym_type_t::section);
+  // section symbols are generated in parallel into a slot each, then put into
+  // the table in order on this thread...
+  //
+  std::vector<std::optional<symbol_t>> new_scns(used_scns.size());
+  util::parallel_for(used_scns.size(), m_threads, [&](std::size_t idx) {
+    new_scns[idx].emplace(
+        decompose_scn(used_scns[idx].first, used_scns[idx].second));
+  });
 
-          m_syms->put_symbol(new_scn_sym);
-        }
+  // the data symbols of a section refer to its symbol, so a section symbol
+  // that is not in the table fails decomposition...
+  //
+  for (auto idx = 0u; idx < used_scns.size(); ++idx) {
+    auto [img, scn_idx] = used_scns[idx];
+    auto scn_sym = m_syms->put_symbol(std::move(new_scns[idx].value()));
+    if (!scn_sym)
+      return false;
 
-        // create a symbol for the data...
-        //
-        decomp::symbol_t new_sym(img, symbol_t::name(img, sym).data(),
-                                 sym->value, {}, scn, sym, {},
-                                 sym_type_t::data);
+    m_scn_syms.at(img)[scn_idx] = scn_sym;
+  }
 
-        m_syms->put_symbol(new_sym);
-      }
-    } else if (sym->storage_class ==
-               coff::storage_class_id::
-                   external_definition) {  // else if the symbol has no
-                                           // section... these symbols
-                                           // require the linker to allocate
-                                           // space for them...
-
-      std::vector<std::uint8_t> data(sym->value, 0);
-      decomp::symbol_t bss_sym(img, symbol_t::name(img, sym).data(), {}, data,
-                               {}, sym, {}, sym_type_t::data);
-
-      m_syms->put_symbol(bss_sym);
-    }
+  // generate symbols for every used symbol. symbols are independent of each
+  // other so they are generated in parallel, the same way as the section
+  // symbols...
+  //
+  std::vector<std::optional<symbol_t>> new_syms(ordered.size());
+  util::parallel_for(ordered.size(), m_threads, [&](std::size_t idx) {
+    new_syms[idx] = decompose_sym(ordered[idx]);
   });
 
-  // return the extract symbols to the caller...
+  auto res = true;
+  for (auto& new_sym : new_syms)
+    if (new_sym.has_value())
+      res &= m_syms->put_symbol(std::move(new_sym.value())) != nullptr;
+
+  return res;
+}
+
+symbol_t decomp_t::decompose_scn(const coff::image_t* img,
+                                 std::uint32_t scn_idx) {
+  auto scn = img->get_section(scn_idx);
+
+  // extract the relocations needed for this section...
   //
-  return m_syms;
+  relocs_t relocs;
+  for (auto& scn_reloc : scn_relocs(img, scn)) {
+    relocs.push_back(recomp::reloc_t(
+        scn_reloc.virtual_address, sym_name(img, scn_reloc.symbol_index)));
+  }
+
+  // create a new section symbol. uninitialized data sections get zero filled
+  // bytes, all other sections view their raw data...
+  //
+  if (scn->characteristics.cnt_uninit_data) {
+    bytes_t scn_data(scn->size_raw_data, 0);
+    return decomp::symbol_t(img, scn_sym_name(img, scn_idx), 0, scn_data, scn,
+                            {}, relocs, sym_type_t::section);
+  }
+
+  std::span<const std::uint8_t> scn_data(
+      reinterpret_cast<const std::uint8_t*>(img) + scn->ptr_raw_data,
+      scn->size_raw_data);
+
+  return decomp::symbol_t(img, scn_sym_name(img, scn_idx), 0, scn_data, scn,
+                          {}, relocs, sym_type_t::section);
 }
 
-std::uint32_t decomp_t::next_sym(coff::image_t* img,
-                                 coff::section_header_t* hdr,
-                                 coff::symbol_t* s) {
-  // loop over all symbols in this object...
-  // find the next symbol inside of the same section...
-  // if there is no next symbol then we use the end of the section...
-  std::uint32_t res = hdr->size_raw_data;
+std::optional<symbol_t> decomp_t::decompose_sym(sym_data_t data) {
+  auto [img, sym, size] = data;
+
+  // if the symbol is a function then we are going to decompose it...
+  // data symbols are handled after this...
+  //
+  if (sym->has_section()) {
+    if (sym->derived_type == coff::derived_type_id::function) {
+      auto scn = img->get_section(sym->section_index - 1);
+      auto fn_bgn = scn->ptr_raw_data +
+                    reinterpret_cast<const std::uint8_t*>(img) + sym->value;
+
+      // view the bytes the function is composed of. the size of the function
+      // was computed when the symbol was indexed...
+      //
+      decomp::routine_t rtn(sym, img, scn, {fn_bgn, size},
+                            relocs_in(img, scn, sym->value, size),
+                            m_sym_names.at(img));
+
+      return rtn.decompose();
+      // else the symbol isnt a function and its public or private (some data
+      // symbols are private)...
+    } else if (sym->storage_class == coff::storage_class_id::public_symbol ||
+               sym->storage_class == coff::storage_class_id::private_symbol) {
+      // create a symbol for the data. the section symbol was already created
+      // by decompose_scn, the data symbol refers to it by name so it can be
+      // allocated without the coff image...
+      //
+      auto scn = img->get_section(sym->section_index - 1);
+      decomp::symbol_t new_sym(img, sym_name(img, sym - img->get_symbol(0)),
+                               sym->value, bytes_t{}, scn,
+                               sym, {}, sym_type_t::data);
+
+      new_sym.scn_name(scn_sym(img, scn)->name_id());
+      return new_sym;
+    }
+  } else if (sym->storage_class ==
+             coff::storage_class_id::
+                 external_definition) {  // else if the symbol has no
+                                         // section... these symbols
+                                         // require the linker to allocate
+                                         // space for them...
+
+    bytes_t data(sym->value, 0);
+    decomp::symbol_t bss_sym(img, sym_name(img, sym - img->get_symbol(0)), {},
+                             data, {}, sym, {}, sym_type_t::data);
+
+    return bss_sym;
+  }
+
+  return {};
+}
+
+name_id_t decomp_t::scn_sym_name(const coff::image_t* img,
+                                 std::uint32_t scn_idx) {
+  auto scn = img->get_section(scn_idx);
+  return name_pool_t::get()->intern(
+      std::string(scn->name.to_string(img->get_strings()))
+          .append("#")
+          .append(std::to_string(scn_idx))
+          .append("!")
+          .append(std::to_string(img->file_header.timedate_stamp)));
+}
+
+name_id_t decomp_t::sym_name(const coff::image_t* img, std::uint32_t sym_idx) {
+  return m_sym_names.at(img)[sym_idx];
+}
+
+obj_idx_t decomp_t::index_obj(const coff::image_t* img) {
+  obj_idx_t res = {};
+  res.img = img;
+  std::vector<std::pair<std::size_t, sym_data_t>> syms;
+
+  // index the function symbols of this obj once so that sizing each symbol is
+  // a binary search instead of a scan of every symbol...
+  //
+  auto fns = index_fns(img);
+  auto pool = name_pool_t::get();
+
+  // auxiliary records and symbols that are skipped have no name...
+  //
+  res.names.assign(img->file_header.num_symbols, no_name);
+
+  for (auto idx = 0u, aux = 0u; idx < img->file_header.num_symbols; ++idx) {
+    auto sym = img->get_symbol(idx);
+
+    // auxiliary records follow their symbol and are not symbols themselves...
+    //
+    if (aux) {
+      --aux;
+      continue;
+    }
+
+    aux = sym->num_auxiliary;
+    if (sym->section_index - 1 > img->file_header.num_sections)
+      continue;
+
+    // intern the name once, relocations refer to it by symbol index...
+    //
+    res.names[idx] = symbol_t::name(img, sym);
+    auto sym_name = pool->name(res.names[idx]);
+
+    if (sym_name.length()) {
+      auto sym_hash = pool->hash(res.names[idx]);
+      auto sym_size =
+          sym->has_section()
+              ? next_sym(fns, img->get_section(sym->section_index - 1), sym)
+              : 0u;
+
+      syms.push_back({sym_hash, {img, sym, sym_size}});
+      ++res.bounds[sym_hash % lookup_shards + 1];
+    }
+  }
+
+  // group the symbols by shard, keeping the order of the symbols inside of
+  // each shard...
+  //
+  for (auto shard = 0u; shard < lookup_shards; ++shard)
+    res.bounds[shard + 1] += res.bounds[shard];
+
+  auto pos = res.bounds;
+  res.syms.resize(syms.size());
+  for (auto& entry : syms)
+    res.syms[pos[entry.first % lookup_shards]++] = entry;
+
+  return res;
+}
+
+fn_idx_t decomp_t::index_fns(const coff::image_t* img) {
+  fn_idx_t res;
   for (auto idx = 0u; idx < img->file_header.num_symbols; ++idx) {
-    auto q = img->get_symbol(idx);
-    if (q->derived_type == coff::derived_type_id::function &&
-        q->section_index == s->section_index && q != s)
-      if (q->value > s->value && q->value < res)
-        res = q->value;
+    auto sym = img->get_symbol(idx);
+    if (sym->derived_type == coff::derived_type_id::function)
+      res.emplace_back(sym->section_index, sym->value);
   }
+
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+std::uint32_t decomp_t::next_sym(const fn_idx_t& fns,
+                                 const coff::section_header_t* hdr,
+                                 const coff::symbol_t* s) {
+  // find the first function symbol inside of the same section that comes
+  // after this symbol... if there is no next symbol then we use the end of
+  // the section...
+  std::uint32_t res = hdr->size_raw_data;
+  auto itr = std::upper_bound(
+      fns.begin(), fns.end(),
+      std::pair<std::int16_t, std::uint32_t>(s->section_index, s->value));
+
+  if (itr != fns.end() && itr->first == s->section_index && itr->second < res)
+    res = itr->second;
+
   return res;
 }
 
-std::uint32_t decomp_t::ext_used_syms(const std::string&& entry_sym) {
+std::uint32_t decomp_t::ext_used_syms(name_id_t entry_sym) {
   // start with the entry point symbol...
-  std::optional<sym_data_t> entry = get_symbol(entry_sym.data());
+  std::optional<sym_data_t> entry = get_symbol(entry_sym);
 
   // if the entry point symbol cant be found simply return 0 (for 0 symbols
   // extracted)...
   if (!entry.has_value())
     return 0u;
 
-  // little memoization for perf boost... :^)
-  std::set<coff::symbol_t*> cache;
-  const auto finding_syms = [&]() -> bool {
-    // for all the symbols...
-    for (auto itr = m_used_syms.begin(); itr != m_used_syms.end(); ++itr) {
-      auto [img, sym, size] = *itr;
-      // if the symbol has a section and its not already in the cache...
-      if (sym->has_section() && !cache.count(sym) && size) {
-        auto scn = img->get_section(sym->section_index - 1);
-        auto num_relocs = scn->num_relocs;
-        auto relocs = reinterpret_cast<coff::reloc_t*>(
-            scn->ptr_relocs + reinterpret_cast<std::uint8_t*>(img));
-
-        // see if there are any relocations inside of the symbol...
-        for (auto idx = 0u; idx < num_relocs; ++idx) {
-          auto reloc = &relocs[idx];
-          // if the reloc is inside of the current symbol...
-          if (reloc->virtual_address >= sym->value &&
-              reloc->virtual_address < sym->value + size) {
-            // get the symbol for the relocation and add it to the m_used_symbol
-            // vector...
-            auto reloc_sym = img->get_symbol(reloc->symbol_index);
-            auto sym_name = symbol_t::name(img, reloc_sym);
-            entry = get_symbol(sym_name);
-            // if the symbol already exists in the m_used_syms vector then we
-            // return out of this function and continue looping over all symbols
-            // recursively...
-            if (m_used_syms.emplace(entry.value()).second)
-              return true;  // returns to the for loop below this lambda. the
-                            // return true here means we added yet another
-                            // symbol to the "m_used_syms" vector...
-          }
-        }
+  std::vector<sym_data_t> used = {entry.value()};
+  m_used_syms.emplace(entry.value());
+  mark_used(used);
+  return m_used_syms.size();
+}
 
-        // cache the symbol so we dont need to process it again...
-        cache.emplace(sym);
-      }
+void decomp_t::mark_used(std::vector<sym_data_t>& used) {
+  // every symbol is appended exactly once, the first time it is added to
+  // m_used_syms...
+  //
+  for (auto pos = 0u; pos < used.size(); ++pos) {
+    // add the symbol of every relocation inside of the current symbol...
+    //
+    for (auto name : sym_refs(used[pos])) {
+      ++m_refs[name];
+      auto dep = get_symbol(name);
+
+      if (dep.has_value() && m_used_syms.emplace(dep.value()).second)
+        used.push_back(dep.value());
     }
-    return false;  // only ever returns false here when every single symbol
-                   // inside of m_used_syms has been looked at to see if all of
-                   // its relocation symbols are included in the m_used_syms
-                   // vector (meaning we got all the used symbols...)
+  }
+}
+
+void decomp_t::unuse(sym_data_t data, std::vector<name_id_t>& dropped) {
+  m_used_syms.erase(data);
+  for (auto name : sym_refs(data)) {
+    --m_refs[name];
+    dropped.push_back(name);
+  }
+}
+
+std::vector<name_id_t> decomp_t::sym_refs(sym_data_t data) {
+  auto [img, sym, size] = data;
+  std::vector<name_id_t> res;
+  if (!sym->has_section() || !size)
+    return res;
+
+  auto scn = img->get_section(sym->section_index - 1);
+  for (auto& reloc : relocs_in(img, scn, sym->value, size))
+    res.push_back(sym_name(img, reloc.symbol_index));
+
+  return res;
+}
+
+std::span<const coff::reloc_t> decomp_t::scn_relocs(
+    const coff::image_t* img,
+    const coff::section_header_t* scn) {
+  auto itr = m_reloc_tbl.find(scn);
+  if (itr != m_reloc_tbl.end())
+    return itr->second;
+
+  std::span<const coff::reloc_t> relocs(
+      reinterpret_cast<const coff::reloc_t*>(
+          scn->ptr_relocs + reinterpret_cast<const std::uint8_t*>(img)),
+      scn->num_relocs);
+
+  const auto by_va = [](const coff::reloc_t& a, const coff::reloc_t& b) {
+    return a.virtual_address < b.virtual_address;
   };
 
-  // add the entry point symbol...
-  m_used_syms.emplace(entry.value());
+  // relocations are almost always already sorted by virtual address, in which
+  // case they are used in place. otherwise a sorted copy is made...
+  //
+  if (!std::is_sorted(relocs.begin(), relocs.end(), by_va)) {
+    auto& sorted = m_sorted_relocs.emplace_back(relocs.begin(), relocs.end());
+    std::stable_sort(sorted.begin(), sorted.end(), by_va);
+    relocs = sorted;
+  }
 
-  // keep recursively adding symbols until we found them all..
-  for (m_used_syms.emplace(entry.value()); finding_syms();)
-    ;
+  m_reloc_tbl.emplace(scn, relocs);
+  return relocs;
+}
 
-  return m_used_syms.size();
+std::span<const coff::reloc_t> decomp_t::relocs_in(
+    const coff::image_t* img,
+    const coff::section_header_t* scn,
+    std::uint32_t offset,
+    std::uint32_t size) {
+  auto relocs = scn_relocs(img, scn);
+  auto bgn = std::partition_point(
+      relocs.begin(), relocs.end(),
+      [&](const coff::reloc_t& r) { return r.virtual_address < offset; });
+
+  auto end = std::partition_point(
+      bgn, relocs.end(),
+      [&](const coff::reloc_t& r) { return r.virtual_address < offset + size; });
+
+  return {bgn, end};
 }
 
-std::optional<sym_data_t> decomp_t::get_symbol(const std::string_view& name) {
-  coff::image_t* img = {};
-  coff::symbol_t* sym = {};
+bool decomp_t::stream_objs(name_id_t entry_sym) {
+  ar_stream_t stream(*m_stream);
+  if (!stream.valid())
+    return false;
+
+  // an obj read from the stream along with its external symbols...
+  //
+  struct held_t {
+    ar_member_t obj;
+    std::vector<name_id_t> defs;
+    std::vector<name_id_t> refs;
+  };
+
+  std::unordered_set<name_id_t> wanted = {entry_sym}, defined;
+  std::deque<held_t> held;
+  std::size_t held_size = {};
+
+  const auto is_wanted = [&](const std::vector<name_id_t>& defs) {
+    return std::any_of(defs.begin(), defs.end(),
+                       [&](name_id_t def) { return wanted.count(def); });
+  };
+
+  while (auto member = stream.next()) {
+    held_t next = {std::move(member.value())};
+    scan_externals(reinterpret_cast<const coff::image_t*>(next.obj.data.data()),
+                   next.defs, next.refs);
+
+    if (!is_wanted(next.defs)) {
+      // hold the obj back, dropping the oldest held back objs if the limit
+      // would be exceeded...
+      //
+      held_size += next.obj.data.size();
+      held.push_back(std::move(next));
+
+      while (held_size > m_retain_limit && !held.empty()) {
+        spdlog::warn("dropping obj from stream: {}", held.front().obj.name);
+        held_size -= held.front().obj.data.size();
+        held.pop_front();
+      }
+      continue;
+    }
+
+    // keep the obj, then keep every held back obj that defines a symbol that
+    // is wanted because of it...
+    //
+    std::vector<held_t> keep;
+    keep.push_back(std::move(next));
+    while (!keep.empty()) {
+      auto obj = std::move(keep.back());
+      keep.pop_back();
+
+      for (auto def : obj.defs) {
+        wanted.erase(def);
+        defined.insert(def);
+      }
+
+      for (auto ref : obj.refs)
+        if (!defined.count(ref))
+          wanted.insert(ref);
+
+      // the bytes of kept objs are owned by this object, the coff images and
+      // symbols point into them...
+      //
+      spdlog::info("kept obj from stream: {}", obj.obj.name);
+      load_objs({m_obj_bufs.emplace_back(std::move(obj.obj.data))});
+
+      for (auto itr = held.begin(); itr != held.end();) {
+        if (is_wanted(itr->defs)) {
+          held_size -= itr->obj.data.size();
+          keep.push_back(std::move(*itr));
+          itr = held.erase(itr);
+        } else
+          ++itr;
+      }
+    }
+  }
+
+  spdlog::info("dropped {} unused objs from stream...", held.size());
+  return true;
+}
+
+void decomp_t::scan_externals(const coff::image_t* img,
+                              std::vector<name_id_t>& defs,
+                              std::vector<name_id_t>& refs) {
+  for (auto idx = 0u; idx < img->file_header.num_symbols;
+       idx += 1 + img->get_symbol(idx)->num_auxiliary) {
+    auto sym = img->get_symbol(idx);
+    if (sym->storage_class != coff::storage_class_id::public_symbol)
+      continue;
+
+    // symbols without a section but with a value are common symbols, they
+    // are defined by the obj...
+    //
+    if (sym->has_section() || sym->value)
+      defs.push_back(symbol_t::name(img, sym));
+    else
+      refs.push_back(symbol_t::name(img, sym));
+  }
+}
+
+void decomp_t::load_objs(
+    const std::vector<std::span<const std::uint8_t>>& objs) {
+  // spinning up threads for a single obj costs more than indexing it...
+  //
+  auto threads = objs.size() > 1 ? m_threads : 1u;
+
+  // index the symbols of every obj. objs are independent of each other so
+  // they are indexed in parallel...
+  //
+  // objs that are not aligned for the coff structures are copied, the rest
+  // are used in place...
+  //
+  std::vector<std::span<const std::uint8_t>> imgs(objs.begin(), objs.end());
+  for (auto& img : imgs)
+    if (reinterpret_cast<std::uintptr_t>(img.data()) % obj_align)
+      img = m_obj_bufs.emplace_back(img.begin(), img.end());
+
+  std::vector<obj_idx_t> obj_idxs(imgs.size());
+  util::parallel_for(imgs.size(), threads, [&](std::size_t idx) {
+    obj_idxs[idx] =
+        index_obj(reinterpret_cast<const coff::image_t*>(imgs[idx].data()));
+
+    // the hash of the bytes tells whether the obj changed when the lib is
+    // redecomposed...
+    //
+    obj_idxs[idx].hash = util::hash64(
+        {reinterpret_cast<const char*>(imgs[idx].data()), imgs[idx].size()});
+  });
+
+  // merge the indexed symbols into the lookup shards, one thread per shard.
+  // entries are merged in obj order so the lookup table is the same as if it
+  // was built on a single thread...
+  //
+  util::parallel_for(lookup_shards, threads, [&](std::size_t shard) {
+    for (auto& obj_idx : obj_idxs) {
+      for (auto idx = obj_idx.bounds[shard]; idx < obj_idx.bounds[shard + 1];
+           ++idx) {
+        auto& [sym_hash, data] = obj_idx.syms[idx];
+        m_lookup_tbl[shard][sym_hash].push_back(data);
+      }
+    }
+  });
+
+  for (auto& obj_idx : obj_idxs) {
+    m_sym_names.emplace(obj_idx.img, std::move(obj_idx.names));
+    m_obj_hashes.emplace(obj_idx.img, obj_idx.hash);
+  }
+
+  m_objs.insert(m_objs.end(), imgs.begin(), imgs.end());
+}
+
+bool decomp_t::load_members(name_id_t name) {
+  if (!m_ar_idx || !m_ar_idx->valid())
+    return false;
+
+  std::vector<std::span<const std::uint8_t>> objs;
+  for (auto offset : m_ar_idx->members(name_pool_t::get()->name(name))) {
+    if (!m_loaded_members.emplace(offset).second)
+      continue;
+
+    auto obj = m_ar_idx->member(offset);
+    if (obj.empty()) {
+      spdlog::error("invalid archive member at offset: {:X}", offset);
+      continue;
+    }
+
+    spdlog::info("loaded obj from archive at offset: {:X}", offset);
+    objs.push_back(obj);
+  }
+
+  if (objs.empty())
+    return false;
+
+  load_objs(objs);
+  return true;
+}
+
+std::optional<sym_data_t> decomp_t::get_symbol(name_id_t name) {
+  // only a definition with a section is final, otherwise an obj that has not
+  // been loaded yet may define the symbol...
+  //
+  auto res = find_symbol(name);
+  if ((!res.has_value() || !std::get<1>(res.value())->has_section()) &&
+      load_members(name))
+    res = find_symbol(name);
+
+  return res;
+}
+
+std::optional<sym_data_t> decomp_t::find_symbol(name_id_t name) {
+  const coff::image_t* img = {};
+  const coff::symbol_t* sym = {};
   std::uint32_t size = {};
 
-  auto& syms = m_lookup_tbl[symbol_t::hash(name.data())];
+  auto sym_hash = name_pool_t::get()->hash(name);
+  auto& shard = m_lookup_tbl[sym_hash % lookup_shards];
+  auto res = shard.find(sym_hash);
+  if (res == shard.end())
+    return {};
+
+  // prefer the definition of the symbol that has a section...
+  //
+  auto& syms = res->second;
   for (auto idx = 0u; idx < syms.size(); ++idx) {
     img = std::get<0>(syms[idx]);
     sym = std::get<1>(syms[idx]);
@@ -304,15 +938,15 @@ std::optional<sym_data_t> decomp_t::get_symbol(const std::string_view& name) {
   return {};
 }
 
-std::vector<routine_t> decomp_t::rtns() {
+const std::vector<routine_t>& decomp_t::rtns() {
   return m_rtns;
 }
 
-std::vector<std::uint8_t> decomp_t::lib() {
+std::span<const std::uint8_t> decomp_t::lib() {
   return m_lib;
 }
 
-std::vector<std::vector<std::uint8_t>> decomp_t::objs() {
+const std::vector<std::span<const std::uint8_t>>& decomp_t::objs() {
   return m_objs;
 }
 
@@ -320,7 +954,10 @@ recomp::symbol_table_t* decomp_t::syms() {
   return m_syms;
 }
 
-std::map<coff::section_header_t*, std::size_t>& decomp_t::scn_hash_tbl() {
-  return m_scn_hash_tbl;
+symbol_t* decomp_t::scn_sym(const coff::image_t* img,
+                            const coff::section_header_t* scn) {
+  auto itr = m_scn_syms.find(img);
+  return itr != m_scn_syms.end() ? itr->second[scn - img->get_section(0)]
+                                 : nullptr;
 }
 }  // namespace theo::decomp
\ No newline at end of file
@@ -0,0 +1,129 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <decomp/file_map.hpp>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace theo::decomp {
+#ifdef _WIN32
+file_map_t::file_map_t(const std::filesystem::path& path)
+    : m_base(nullptr), m_size(0), m_file(nullptr), m_mapping(nullptr) {
+  auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if (file == INVALID_HANDLE_VALUE) {
+    spdlog::error("failed to open file: {}", path.string());
+    return;
+  }
+
+  LARGE_INTEGER size = {};
+  if (!GetFileSizeEx(file, &size) || !size.QuadPart) {
+    spdlog::error("failed to get file size or file is empty: {}",
+                  path.string());
+    CloseHandle(file);
+    return;
+  }
+
+  auto mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping) {
+    spdlog::error("failed to create file mapping: {}", path.string());
+    CloseHandle(file);
+    return;
+  }
+
+  m_file = file;
+  m_mapping = mapping;
+  m_base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  m_size = m_base ? static_cast<std::size_t>(size.QuadPart) : 0u;
+
+  if (!m_base)
+    spdlog::error("failed to map view of file: {}", path.string());
+}
+
+file_map_t::~file_map_t() {
+  if (m_base)
+    UnmapViewOfFile(m_base);
+
+  if (m_mapping)
+    CloseHandle(m_mapping);
+
+  if (m_file)
+    CloseHandle(m_file);
+}
+#else
+file_map_t::file_map_t(const std::filesystem::path& path)
+    : m_base(nullptr), m_size(0) {
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    spdlog::error("failed to open file: {}", path.string());
+    return;
+  }
+
+  struct stat st = {};
+  if (fstat(fd, &st) == -1 || !st.st_size) {
+    spdlog::error("failed to get file size or file is empty: {}",
+                  path.string());
+    close(fd);
+    return;
+  }
+
+  // the file descriptor can be closed once the mapping exists...
+  //
+  auto base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (base == MAP_FAILED) {
+    spdlog::error("failed to map file: {}", path.string());
+    return;
+  }
+
+  m_base = base;
+  m_size = static_cast<std::size_t>(st.st_size);
+}
+
+file_map_t::~file_map_t() {
+  if (m_base)
+    munmap(m_base, m_size);
+}
+#endif
+
+std::span<const std::uint8_t> file_map_t::data() const {
+  return {reinterpret_cast<const std::uint8_t*>(m_base), m_size};
+}
+}  // namespace theo::decomp
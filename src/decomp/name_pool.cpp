@@ -0,0 +1,129 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <decomp/name_pool.hpp>
+#include <spdlog/spdlog.h>
+#include <util/hash.hpp>
+#include <util/segments.hpp>
+#include <bit>
+#include <cassert>
+
+namespace theo::decomp {
+name_pool_t* name_pool_t::get() {
+  static name_pool_t obj;
+  return &obj;
+}
+
+name_pool_t::~name_pool_t() {
+  for (auto& seg : m_segs)
+    delete[] seg.load();
+}
+
+name_id_t name_pool_t::intern(std::string_view name) {
+  // the hash picks the shard so it is computed before taking any lock...
+  //
+  auto shift = 64 - std::countr_zero(num_shards);
+  auto hash = util::hash64(name);
+  auto& shard = m_shards[hash >> shift];
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mtx);
+    auto itr = shard.ids.find(name);
+    if (itr != shard.ids.end())
+      return itr->second;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(shard.mtx);
+  auto itr = shard.ids.find(name);
+  if (itr != shard.ids.end())
+    return itr->second;
+
+  // the name is not in the pool yet, so an existing entry with the same hash
+  // is a real collision. the name gets a seeded hash instead, with the top
+  // bits of the first hash so that it stays in this shard where the new hash
+  // can be checked as well...
+  //
+  if (auto itr = shard.hashes.find(hash); itr != shard.hashes.end()) {
+    spdlog::warn("[name_pool_t] hash collision between {} and {}", name,
+                 entry(itr->second).name);
+
+    auto top = ~std::uint64_t{} << shift;
+    for (std::uint64_t seed = 1; shard.hashes.count(hash); ++seed)
+      hash = (hash & top) | (util::hash64(name, seed) & ~top);
+  }
+
+  auto id = new_id();
+  auto& res = entry(id);
+  res.name = name;
+  res.hash = hash;
+
+  // the key views the pooled copy of the name which never moves...
+  //
+  shard.ids.emplace(res.name, id);
+  shard.hashes.emplace(hash, id);
+  return id;
+}
+
+std::string_view name_pool_t::name(name_id_t id) const {
+  return entry(id).name;
+}
+
+std::uint64_t name_pool_t::hash(name_id_t id) const {
+  return entry(id).hash;
+}
+
+std::uint32_t name_pool_t::size() const {
+  return m_size.load();
+}
+
+name_pool_t::entry_t& name_pool_t::entry(name_id_t id) const {
+  assert(id < m_size.load());
+  auto [seg, idx] = util::segment_of(id, seg_base);
+  return m_segs[seg].load(std::memory_order_acquire)[idx];
+}
+
+name_id_t name_pool_t::new_id() {
+  // ids are handed out across every shard. the segment of an id is allocated
+  // by whichever thread gets there first, this lock is only taken when a
+  // segment is missing...
+  //
+  auto id = m_size.fetch_add(1);
+  auto [seg, idx] = util::segment_of(id, seg_base);
+  assert(seg < max_segs);
+
+  if (!m_segs[seg].load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(m_segs_mtx);
+    if (!m_segs[seg].load(std::memory_order_relaxed))
+      m_segs[seg].store(new entry_t[util::segment_size(seg, seg_base)],
+                        std::memory_order_release);
+  }
+
+  return id;
+}
+}  // namespace theo::decomp
@@ -31,45 +31,41 @@
 #include <decomp/routine.hpp>
 
 namespace theo::decomp {
-routine_t::routine_t(coff::symbol_t* sym,
-                     coff::image_t* img,
-                     coff::section_header_t* scn,
-                     std::vector<std::uint8_t>& fn)
-    : m_img(img), m_scn(scn), m_data(fn), m_sym(sym) {}
+routine_t::routine_t(const coff::symbol_t* sym,
+                     const coff::image_t* img,
+                     const coff::section_header_t* scn,
+                     std::span<const std::uint8_t> fn,
+                     std::span<const coff::reloc_t> relocs,
+                     std::span<const name_id_t> names)
+    : m_img(img),
+      m_scn(scn),
+      m_data(fn),
+      m_relocs(relocs),
+      m_names(names),
+      m_sym(sym) {}
 
 decomp::symbol_t routine_t::decompose() {
-  std::vector<recomp::reloc_t> relocs;
-  auto scn_relocs = reinterpret_cast<coff::reloc_t*>(
-      m_scn->ptr_relocs + reinterpret_cast<std::uint8_t*>(m_img));
+  relocs_t relocs;
 
-  // extract all of the relocations that this function has...
+  // extract all of the relocations that this function has. the relocations
+  // passed to this routine are already limited to the function...
   //
-  for (auto idx = 0u; idx < m_scn->num_relocs; ++idx) {
-    auto scn_reloc = &scn_relocs[idx];
-    // if the reloc is in the current function...
-    if (scn_reloc->virtual_address >= m_sym->value &&
-        scn_reloc->virtual_address < m_sym->value + m_data.size()) {
-      auto sym_reloc = m_img->get_symbol(scn_relocs[idx].symbol_index);
-      auto sym_name = symbol_t::name(m_img, sym_reloc);
-      auto sym_hash = decomp::symbol_t::hash(sym_name.data());
-      relocs.push_back(
-          recomp::reloc_t(scn_reloc->virtual_address - m_sym->value, sym_hash,
-                          sym_name.data()));
-    }
-  }
+  for (auto& scn_reloc : m_relocs)
+    relocs.push_back(recomp::reloc_t(scn_reloc.virtual_address - m_sym->value,
+                                     m_names[scn_reloc.symbol_index]));
 
   // return the created symbol_t for this function...
   //
-  return decomp::symbol_t(m_img, symbol_t::name(m_img, m_sym).data(),
-                          m_sym->value, m_data, m_scn, m_sym, relocs,
-                          sym_type_t::function);
+  return decomp::symbol_t(m_img, m_names[m_sym - m_img->get_symbol(0)],
+                          m_sym->value, m_data, m_scn, m_sym,
+                          std::move(relocs), sym_type_t::function);
 }
 
-coff::section_header_t* routine_t::scn() {
+const coff::section_header_t* routine_t::scn() {
   return m_scn;
 }
 
-std::vector<std::uint8_t> routine_t::data() {
+std::span<const std::uint8_t> routine_t::data() {
   return m_data;
 }
 }  // namespace theo::decomp
\ No newline at end of file
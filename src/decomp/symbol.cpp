@@ -31,25 +31,59 @@
 #include <decomp/symbol.hpp>
 
 namespace theo::decomp {
-symbol_t::symbol_t(coff::image_t* img,
-                   std::string name,
+symbol_t::symbol_t(const coff::image_t* img,
+                   name_id_t name,
                    std::uintptr_t offset,
-                   std::vector<std::uint8_t> data,
-                   coff::section_header_t* scn,
-                   coff::symbol_t* sym,
-                   std::vector<recomp::reloc_t> relocs,
+                   bytes_t data,
+                   const coff::section_header_t* scn,
+                   const coff::symbol_t* sym,
+                   relocs_t relocs,
                    sym_type_t dcmp_type)
-    : m_name(name),
+    : m_sym_type(dcmp_type),
+      m_name(name),
+      m_allocated_at(0),
+      m_data(std::move(data)),
+      m_relocs(std::move(relocs)),
       m_offset(offset),
-      m_data(data),
+      m_scn_chars(scn ? scn->characteristics
+                      : coff::section_characteristics_t{}),
+      m_scn_name(no_name),
       m_scn(scn),
-      m_relocs(relocs),
-      m_sym_type(dcmp_type),
       m_sym(sym),
       m_img(img),
-      m_allocated_at(0) {}
+      m_decoded_at(nullptr),
+      m_data_ver(0),
+      m_decoded_ver(0) {}
 
-std::string symbol_t::name() const {
+symbol_t::symbol_t(const coff::image_t* img,
+                   name_id_t name,
+                   std::uintptr_t offset,
+                   std::span<const std::uint8_t> view,
+                   const coff::section_header_t* scn,
+                   const coff::symbol_t* sym,
+                   relocs_t relocs,
+                   sym_type_t dcmp_type)
+    : m_sym_type(dcmp_type),
+      m_name(name),
+      m_allocated_at(0),
+      m_view(view),
+      m_relocs(std::move(relocs)),
+      m_offset(offset),
+      m_scn_chars(scn ? scn->characteristics
+                      : coff::section_characteristics_t{}),
+      m_scn_name(no_name),
+      m_scn(scn),
+      m_sym(sym),
+      m_img(img),
+      m_decoded_at(nullptr),
+      m_data_ver(0),
+      m_decoded_ver(0) {}
+
+std::string_view symbol_t::name() const {
+  return name_pool_t::get()->name(m_name);
+}
+
+name_id_t symbol_t::name_id() const {
   return m_name;
 }
 
@@ -61,22 +95,93 @@ std::uintptr_t symbol_t::allocated_at() const {
   return m_allocated_at;
 }
 
-coff::section_header_t* symbol_t::scn() const {
+const coff::section_header_t* symbol_t::scn() const {
   return m_scn;
 }
 
-coff::image_t* symbol_t::img() const {
+coff::section_characteristics_t symbol_t::scn_chars() const {
+  return m_scn_chars;
+}
+
+void symbol_t::scn_chars(coff::section_characteristics_t chars) {
+  m_scn_chars = chars;
+}
+
+name_id_t symbol_t::scn_name() const {
+  return m_scn_name;
+}
+
+void symbol_t::scn_name(name_id_t name) {
+  m_scn_name = name;
+}
+
+const coff::image_t* symbol_t::img() const {
   return m_img;
 }
 
 std::uint32_t symbol_t::size() const {
-  return m_data.size();
+  return bytes().size();
 }
 
-std::vector<std::uint8_t>& symbol_t::data() {
+bytes_t& symbol_t::data() {
+  // copy borrowed data into the vector the first time it is requested for
+  // modification...
+  //
+  if (!m_view.empty()) {
+    m_data.assign(m_view.begin(), m_view.end());
+    m_view = {};
+  }
+
+  ++m_data_ver;
   return m_data;
 }
 
+void symbol_t::append(std::span<const std::uint8_t> bytes) {
+  auto valid = m_decoded.get() && m_decoded_ver == m_data_ver;
+  auto& data = this->data();
+  data.insert(data.end(), bytes.begin(), bytes.end());
+
+  // the instruction is the same, decoded notices if the bytes moved to the
+  // heap and decodes it again there...
+  //
+  if (valid)
+    m_decoded_ver = m_data_ver;
+}
+
+std::uint32_t symbol_t::data_version() const {
+  return m_data_ver;
+}
+
+const xed_decoded_inst_t* symbol_t::decoded() {
+  // the decoded instruction points at the bytes it was decoded from. short
+  // instructions are stored inline and move with the symbol, so a symbol that
+  // moved since it was decoded is decoded again. symbols in the symbol table
+  // never move...
+  //
+  auto bytes = this->bytes();
+  auto inst = m_decoded.get();
+  if (!inst || m_decoded_ver != m_data_ver || m_decoded_at != bytes.data()) {
+    if (!(inst = m_decoded.acquire()))
+      return nullptr;
+
+    xed_state_t istate{XED_MACHINE_MODE_LONG_64, XED_ADDRESS_WIDTH_64b};
+    xed_decoded_inst_zero_set_mode(inst, &istate);
+    if (xed_decode(inst, bytes.data(), bytes.size()) != XED_ERROR_NONE) {
+      m_decoded.reset();
+      return nullptr;
+    }
+
+    m_decoded_at = bytes.data();
+    m_decoded_ver = m_data_ver;
+  }
+
+  return inst;
+}
+
+std::span<const std::uint8_t> symbol_t::bytes() const {
+  return m_view.empty() ? std::span<const std::uint8_t>(m_data) : m_view;
+}
+
 sym_type_t symbol_t::type() const {
   return m_sym_type;
 }
@@ -89,23 +194,24 @@ void symbol_t::allocated_at(std::uintptr_t allocated_at) {
   m_allocated_at = allocated_at;
 }
 
-std::size_t symbol_t::hash() {
-  return hash(m_name);
+std::size_t symbol_t::hash() const {
+  return name_pool_t::get()->hash(m_name);
 }
 
-coff::symbol_t* symbol_t::sym() const {
+const coff::symbol_t* symbol_t::sym() const {
   return m_sym;
 }
 
-std::vector<recomp::reloc_t>& symbol_t::relocs() {
+relocs_t& symbol_t::relocs() {
   return m_relocs;
 }
 
-std::size_t symbol_t::hash(const std::string& sym) {
-  return std::hash<std::string>{}(sym);
+std::size_t symbol_t::hash(std::string_view sym) {
+  auto pool = name_pool_t::get();
+  return pool->hash(pool->intern(sym));
 }
 
-std::string symbol_t::name(const coff::image_t* img, coff::symbol_t* sym) {
+name_id_t symbol_t::name(const coff::image_t* img, const coff::symbol_t* sym) {
   if (sym->has_section() &&
       sym->storage_class == coff::storage_class_id::private_symbol &&
       sym->derived_type == coff::derived_type_id::none) {
@@ -118,8 +224,8 @@ std::string symbol_t::name(const coff::image_t* img, coff::symbol_t* sym) {
                    .append("+")
                    .append(std::to_string(sym->value));
 
-    return res;
+    return name_pool_t::get()->intern(res);
   }
-  return std::string(sym->name.to_string(img->get_strings()));
+  return name_pool_t::get()->intern(sym->name.to_string(img->get_strings()));
 }
 }  // namespace theo::decomp
\ No newline at end of file
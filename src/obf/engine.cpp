@@ -29,6 +29,10 @@
 //
 
 #include <obf/engine.hpp>
+#include <cassert>
+#include <iterator>
+#include <unordered_map>
+#include <util/hash.hpp>
 
 namespace theo::obf {
 engine_t* engine_t::get() {
@@ -38,13 +42,260 @@ engine_t* engine_t::get() {
 
 void engine_t::add_pass(pass_t* pass) {
   passes.push_back(pass);
+  schedule();
 }
 
 void engine_t::for_each(decomp::symbol_t* sym, engine_callback_t callback) {
-  std::for_each(passes.begin(), passes.end(), [&](pass_t* pass) {
-    if (sym->type() & pass->sym_type())
-      callback(sym, pass);
+  std::for_each(m_order.begin(), m_order.end(), [&](std::size_t idx) {
+    if (sym->type() & passes[idx]->sym_type())
+      callback(sym, passes[idx]);
   });
 }
 
-}  // namespace theo::obf
\ No newline at end of file
+bool engine_t::for_each(decomp::symbol_t* sym,
+                        decomp::sym_type_t type,
+                        engine_callback_t callback) {
+  auto ran = false;
+  for (auto idx : m_order) {
+    if (!(type & passes[idx]->sym_type()))
+      continue;
+
+    callback(sym, passes[idx]);
+    ran = true;
+  }
+  return ran;
+}
+
+void engine_t::schedule() {
+  // a pass must run after every other pass that produces something it
+  // requires...
+  //
+  std::vector<std::vector<std::size_t>> after(passes.size());
+  std::vector<std::size_t> num_deps(passes.size());
+  for (auto idx = 0u; idx < passes.size(); ++idx)
+    for (auto dep = 0u; dep < passes.size(); ++dep)
+      if (idx != dep && passes[idx]->required() & passes[dep]->produced()) {
+        after[dep].push_back(idx);
+        ++num_deps[idx];
+      }
+
+  // of the passes that can run, the one added first runs first so passes
+  // that declare nothing keep the order they were added in...
+  //
+  std::vector<bool> done(passes.size());
+  m_order.clear();
+  while (m_order.size() < passes.size()) {
+    auto idx = 0u;
+    while (idx < passes.size() && (done[idx] || num_deps[idx]))
+      ++idx;
+
+    if (idx == passes.size()) {
+      spdlog::error("passes require each other, they cannot be scheduled...");
+      assert(idx != passes.size());
+      break;
+    }
+
+    done[idx] = true;
+    m_order.push_back(idx);
+    for (auto next : after[idx])
+      --num_deps[next];
+  }
+
+  // fuse adjacent passes that run the same way into one stage...
+  //
+  m_stages.clear();
+  for (auto idx : m_order) {
+    auto serial = passes[idx]->scope() == pass_scope_t::global;
+    if (m_stages.empty() || m_stages.back().serial != serial)
+      m_stages.push_back({serial, {}});
+
+    m_stages.back().passes.push_back(idx);
+  }
+}
+
+std::size_t engine_t::run(sym_map_t& sym_tbl,
+                          std::uint32_t types,
+                          std::uint32_t from,
+                          util::stats_t* stats) {
+  // the symbols are collected first so the ones added by the passes are not
+  // visited and every stage sees the same symbols in the same order...
+  //
+  std::vector<decomp::symbol_t*> syms;
+  sym_tbl.for_each(types, from,
+                   [&](decomp::symbol_t& sym) { syms.push_back(&sym); });
+
+  // the counters are only touched when stats are collected...
+  //
+  std::vector<counters_t> counters(stats ? passes.size() : 0);
+
+  for (auto& stage : m_stages) {
+    // passes that take none of the types are left out of the stage...
+    //
+    auto by_fn = false;
+    std::vector<std::size_t> stage_passes;
+    for (auto idx : stage.passes) {
+      auto pass_types = static_cast<std::uint32_t>(passes[idx]->sym_type());
+      if (!(pass_types & types))
+        continue;
+
+      by_fn |= passes[idx]->scope() == pass_scope_t::per_function;
+      stage_passes.push_back(idx);
+    }
+
+    if (stage_passes.empty())
+      continue;
+
+    // the symbols are split into batches that dont depend on the number of
+    // threads. a global stage gets every symbol in one batch, a stage with a
+    // pass that works per function gets the symbols of each function, every
+    // other stage gets runs of batch_size symbols...
+    //
+    std::vector<std::vector<decomp::symbol_t*>> fns;
+    std::vector<std::span<decomp::symbol_t*>> batches;
+    if (stage.serial) {
+      batches.emplace_back(syms);
+    } else if (by_fn) {
+      fns = split_fns(syms);
+      batches.assign(fns.begin(), fns.end());
+    } else {
+      for (std::size_t bgn = 0; bgn < syms.size(); bgn += batch_size)
+        batches.emplace_back(syms.data() + bgn,
+                             std::min(batch_size, syms.size() - bgn));
+    }
+
+    // every pass of a stage runs on a batch before the next pass does, and
+    // every pass is done with a batch before the next batch. the type of every
+    // symbol is checked for every pass since an earlier pass may have changed
+    // it, func_split_pass_t replaces a function with its first instruction in
+    // place...
+    //
+    const auto run_batch = [&](std::span<decomp::symbol_t*> batch) {
+      std::vector<decomp::symbol_t*> typed;
+      for (auto idx : stage_passes) {
+        typed.clear();
+        std::copy_if(batch.begin(), batch.end(), std::back_inserter(typed),
+                     [&](decomp::symbol_t* sym) {
+                       return sym->type() & passes[idx]->sym_type();
+                     });
+
+        if (!typed.empty())
+          run_pass(idx, typed, sym_tbl, stats,
+                   stats ? &counters[idx] : nullptr);
+      }
+    };
+
+    auto stage_bgn = stats ? stats->now() : 0;
+    if (stage.serial)
+      std::for_each(batches.begin(), batches.end(), run_batch);
+    else
+      util::parallel_for(batches.size(), m_threads,
+                         [&](std::size_t idx) { run_batch(batches[idx]); });
+
+    if (!stats)
+      continue;
+
+    // the wall time of a pass runs from the start of its first batch to the end
+    // of its last one. a pass that got no batch is shown at the start of the
+    // stage...
+    //
+    for (auto idx : stage_passes) {
+      auto& cnt = counters[idx];
+      auto ran = cnt.syms_visited != 0;
+      auto bgn = ran ? cnt.bgn_ns.load() : stage_bgn;
+      auto end = ran ? cnt.end_ns.load() : stage_bgn;
+
+      stats->add({std::string(passes[idx]->name()),
+                  static_cast<std::uint32_t>(idx + 1), bgn, end - bgn,
+                  cnt.syms_visited, cnt.syms_created, cnt.bytes_added,
+                  cnt.relocs_added, cnt.cpu_ns});
+    }
+  }
+
+  return syms.size();
+}
+
+std::vector<std::vector<decomp::symbol_t*>> engine_t::split_fns(
+    const std::vector<decomp::symbol_t*>& syms) {
+  // group the instructions by the function they were split from. their
+  // names are the name of the function followed by @offset, except for the
+  // first instruction which has the name of the function...
+  //
+  std::vector<std::vector<decomp::symbol_t*>> fns;
+  std::unordered_map<std::string_view, std::size_t> fn_idx;
+  for (auto sym : syms) {
+    auto fn_name = sym->name();
+    if (sym->type() == decomp::sym_type_t::instruction && sym->offset())
+      fn_name.remove_suffix(std::to_string(sym->offset()).size() + 1);
+
+    auto [itr, added] = fn_idx.try_emplace(fn_name, fns.size());
+    if (added)
+      fns.emplace_back();
+
+    fns[itr->second].push_back(sym);
+  }
+
+  return fns;
+}
+
+void engine_t::run_pass(std::size_t idx,
+                        std::span<decomp::symbol_t*> batch,
+                        sym_map_t& sym_tbl,
+                        util::stats_t* stats,
+                        counters_t* counters) {
+  auto pass = passes[idx];
+
+  // each pass draws its own random numbers for each batch. the batches dont
+  // depend on the number of threads so neither does the output...
+  //
+  transform::operation_t::seed(
+      util::hash64(batch.front()->name(), m_seed + idx));
+
+  // the pass may have changed the symbols it was given, their rows in the hot
+  // columns of the table are brought up to date...
+  //
+  if (!counters) {
+    pass->batch_pass(batch, sym_tbl);
+    sym_tbl.refresh(batch);
+    return;
+  }
+
+  const auto sizes = [&]() {
+    std::pair<std::uint64_t, std::uint64_t> res;
+    for (auto sym : batch) {
+      res.first += sym->bytes().size();
+      res.second += sym->relocs().size();
+    }
+    return res;
+  };
+
+  // func_split_pass_t replaces symbols with smaller ones so only growth is
+  // counted. passes that are not global dont add symbols, so the watermark
+  // only moves because of this pass...
+  //
+  auto [num_bytes, num_relocs] = sizes();
+  std::uint64_t watermark = sym_tbl.watermark(), bgn = stats->now();
+
+  pass->batch_pass(batch, sym_tbl);
+  std::uint64_t end = stats->now();
+  sym_tbl.refresh(batch);
+
+  // batches of a pass run on several threads at once, the first start and the
+  // last end of any of them are kept...
+  //
+  auto first = counters->bgn_ns.load();
+  while (bgn < first && !counters->bgn_ns.compare_exchange_weak(first, bgn)) {
+  }
+
+  auto last = counters->end_ns.load();
+  while (end > last && !counters->end_ns.compare_exchange_weak(last, end)) {
+  }
+
+  auto [new_bytes, new_relocs] = sizes();
+  counters->cpu_ns += end - bgn;
+
+  counters->syms_visited += batch.size();
+  counters->syms_created += sym_tbl.watermark() - watermark;
+  counters->bytes_added += std::max(new_bytes, num_bytes) - num_bytes;
+  counters->relocs_added += std::max(new_relocs, num_relocs) - num_relocs;
+}
+}  // namespace theo::obf
@@ -42,76 +42,72 @@ void func_split_pass_t::generic_pass(decomp::symbol_t* sym,
   xed_error_enum_t err;
   xed_decoded_inst_t instr;
   std::vector<decomp::symbol_t> result;
+  auto fn_bytes = sym->bytes();
+  auto fn_name = sym->name();
+  auto& fn_relocs = sym->relocs();
+  auto pool = decomp::name_pool_t::get();
   xed_state_t istate{XED_MACHINE_MODE_LONG_64, XED_ADDRESS_WIDTH_64b};
   xed_decoded_inst_zero_set_mode(&instr, &istate);
 
   // keep looping over the function, lower the number of bytes each time...
   //
-  while ((err = xed_decode(&instr, sym->data().data() + offset,
-                           sym->data().size() - offset)) == XED_ERROR_NONE) {
+  while ((err = xed_decode(&instr, fn_bytes.data() + offset,
+                           fn_bytes.size() - offset)) == XED_ERROR_NONE) {
     // symbol name is of the format: symbol@instroffset, I.E: main@11...
-    //
-    auto new_sym_name = decomp::symbol_t::name(sym->img(), sym->sym());
-
     // first instruction doesnt need the @offset...
     //
-    if (offset)
-      new_sym_name.append("@").append(std::to_string(offset));
+    auto inst_len = xed_decoded_inst_get_length(&instr);
+    auto new_sym_name =
+        offset ? pool->intern(std::string(fn_name).append("@").append(
+                     std::to_string(offset)))
+               : sym->name_id();
 
-    std::vector<recomp::reloc_t> relocs;
-    auto scn_relocs = reinterpret_cast<coff::reloc_t*>(
-        sym->scn()->ptr_relocs + reinterpret_cast<std::uint8_t*>(sym->img()));
-
-    // find if this instruction has a relocation or not...
-    // if so, return the reloc_t...
+    // find if this instruction has a relocation or not. the relocations of
+    // the function were already extracted when it was decomposed...
     //
-    auto reloc = std::find_if(
-        scn_relocs, scn_relocs + sym->scn()->num_relocs,
-        [&](coff::reloc_t reloc) {
-          return reloc.virtual_address >= sym->sym()->value + offset &&
-                 reloc.virtual_address <
-                     sym->sym()->value + offset +
-                         xed_decoded_inst_get_length(&instr);
-        });
+    decomp::relocs_t relocs;
+    auto reloc = std::find_if(fn_relocs.begin(), fn_relocs.end(),
+                              [&](recomp::reloc_t& reloc) {
+                                return reloc.offset() >= offset &&
+                                       reloc.offset() < offset + inst_len;
+                              });
 
     // if there is indeed a reloc for this instruction...
     //
-    if (reloc != scn_relocs + sym->scn()->num_relocs) {
-      auto sym_reloc = sym->img()->get_symbol(reloc->symbol_index);
-      auto sym_name = decomp::symbol_t::name(sym->img(), sym_reloc);
-      auto sym_hash = decomp::symbol_t::hash(sym_name.data());
-      auto reloc_offset = reloc->virtual_address - sym->sym()->value - offset;
+    if (reloc != fn_relocs.end())
       relocs.push_back(
-          recomp::reloc_t(reloc_offset, sym_hash, sym_name.data()));
-    }
+          recomp::reloc_t(reloc->offset() - offset, reloc->name_id()));
+
     // add a reloc to the next instruction...
     // note that the offset is ZERO... comp_t will understand that
     // relocs with offset ZERO means the next instructions...
     //
-    auto next_inst_sym = decomp::symbol_t::name(sym->img(), sym->sym())
-                             .append("@")
-                             .append(std::to_string(
-                                 offset + xed_decoded_inst_get_length(&instr)));
+    auto next_inst_sym = pool->intern(std::string(fn_name).append("@").append(
+        std::to_string(offset + inst_len)));
+
+    relocs.push_back(recomp::reloc_t(0, next_inst_sym));
 
-    relocs.push_back(recomp::reloc_t(0, decomp::symbol_t::hash(next_inst_sym),
-                                     next_inst_sym.data()));
     // get the instructions bytes
     //
-    std::vector<std::uint8_t> inst_bytes(
-        sym->data().data() + offset,
-        sym->data().data() + offset + xed_decoded_inst_get_length(&instr));
+    decomp::bytes_t inst_bytes(fn_bytes.data() + offset,
+                               fn_bytes.data() + offset + inst_len);
+
+    auto& inst_sym = result.emplace_back(
+        sym->img(), new_sym_name, offset, std::move(inst_bytes), sym->scn(),
+        sym->sym(), std::move(relocs), decomp::sym_type_t::instruction);
 
-    result.push_back(decomp::symbol_t(sym->img(), new_sym_name, offset,
-                                      inst_bytes, sym->scn(), sym->sym(),
-                                      relocs, decomp::sym_type_t::instruction));
+    // the coff image is not loaded when the symbols come from a table file so
+    // the section characteristics are copied from the function...
+    //
+    inst_sym.scn_chars(sym->scn_chars());
     // after creating the symbol and dealing with relocs then print the
     // information we have concluded...
     //
     char buff[255];
-    offset += xed_decoded_inst_get_length(&instr);
+    offset += inst_len;
     xed_format_context(XED_SYNTAX_INTEL, &instr, buff, sizeof buff, NULL, NULL,
                        NULL);
-    spdlog::info("[func_split_pass_t] {}: {}", new_sym_name, buff);
+    spdlog::info("[func_split_pass_t] {}: {}", pool->name(new_sym_name), buff);
     // need to set this so that instr can be used to decode again...
     xed_decoded_inst_zero_set_mode(&instr, &istate);
   }
@@ -122,14 +118,16 @@ void func_split_pass_t::generic_pass(decomp::symbol_t* sym,
   auto& last_inst_relocs = last_inst.relocs();
   last_inst_relocs.erase(last_inst_relocs.end() - 1);
 
-  // insert the split instructions into the symbol table.
+  // insert the split instructions into the symbol table. the first
+  // instruction replaces the function symbol since it has the same name. the
+  // symbols decode their instruction from their own bytes when a later pass
+  // asks for it, instr points into the bytes of the function which are
+  // destroyed by the replace...
   //
-  for (auto& symbol : result) {
-    auto itr = sym_tbl.find(symbol.hash());
-    if (itr != sym_tbl.end())
-      itr->second = symbol;
-    else
-      sym_tbl.insert({symbol.hash(), symbol});
+  for (auto idx = 0u; idx < result.size(); ++idx) {
+    if (!sym_tbl.replace(std::move(result[idx])))
+      spdlog::error("[func_split_pass_t] failed to add instruction {} of {}",
+                    idx, fn_name);
   }
 }
 }  // namespace theo::obf
\ No newline at end of file
@@ -40,10 +40,14 @@ jcc_rewrite_pass_t* jcc_rewrite_pass_t::get() {
 void jcc_rewrite_pass_t::generic_pass(decomp::symbol_t* sym,
                                       sym_map_t& sym_tbl) {
   std::int32_t disp = {};
-  xed_decoded_inst_t inst;
-  xed_state_t istate{XED_MACHINE_MODE_LONG_64, XED_ADDRESS_WIDTH_64b};
-  xed_decoded_inst_zero_set_mode(&inst, &istate);
-  xed_decode(&inst, sym->data().data(), XED_MAX_INSTRUCTION_BYTES);
+  auto decoded = sym->decoded();
+  if (!decoded)
+    return;
+
+  // the decoded instruction is turned into an encoder request below so the
+  // cached one is copied...
+  //
+  xed_decoded_inst_t inst = *decoded;
 
   // if the instruction is branching...
   if ((disp = xed_decoded_inst_get_branch_displacement(&inst))) {
@@ -51,7 +55,7 @@ void jcc_rewrite_pass_t::generic_pass(decomp::symbol_t* sym,
 
     // update displacement...
     xed_decoded_inst_set_branch_displacement(
-        &inst, sym->data().size() - xed_decoded_inst_get_length(&inst),
+        &inst, sym->bytes().size() - xed_decoded_inst_get_length(&inst),
         xed_decoded_inst_get_branch_displacement_width(&inst));
 
     xed_encoder_request_init_from_decode(&inst);
@@ -67,14 +71,19 @@ void jcc_rewrite_pass_t::generic_pass(decomp::symbol_t* sym,
     auto offset = disp < 0 ? sym->offset() - std::abs(disp)
                            : sym->offset() + std::abs(disp);
 
-    auto sym_name =
-        std::string(
-            sym->sym()->name.to_string(sym->img()->get_strings()).data())
-            .append("@")
-            .append(std::to_string(offset));
+    // the name of an instruction is the name of its function followed by
+    // @offset, except for the first instruction which has the name of the
+    // function...
+    //
+    auto pool = decomp::name_pool_t::get();
+    auto fn_name = sym->name();
+    if (sym->offset())
+      fn_name.remove_suffix(std::to_string(sym->offset()).size() + 1);
+
+    auto sym_name = pool->intern(
+        std::string(fn_name).append("@").append(std::to_string(offset)));
 
-    sym->relocs().push_back(
-        recomp::reloc_t(0, decomp::symbol_t::hash(sym_name), sym_name.data()));
+    sym->relocs().push_back(recomp::reloc_t(0, sym_name));
 
     // run next_inst_pass on this symbol to generate the transformations for the
     // relocation to the jcc branch dest instruction...
@@ -30,6 +30,8 @@
 
 #include <obf/passes/next_inst_pass.hpp>
 
+#include <array>
+
 namespace theo::obf {
 next_inst_pass_t* next_inst_pass_t::get() {
   static next_inst_pass_t obj;
@@ -85,11 +87,11 @@ void next_inst_pass_t::generic_pass(decomp::symbol_t* sym, sym_map_t& sym_tbl) {
   //
   new_inst_bytes.push_back(0xC3);
 
-  sym->data().insert(sym->data().end(), new_inst_bytes.begin(),
-                     new_inst_bytes.end());
-
-  reloc.value()->offset(sym->data().size());
-  sym->data().resize(sym->data().size() + 8);
+  // the address of the next instruction is stored after the ret...
+  //
+  sym->append(new_inst_bytes);
+  reloc.value()->offset(sym->bytes().size());
+  sym->append(std::array<std::uint8_t, 8>{});
 }
 
 std::optional<recomp::reloc_t*> next_inst_pass_t::has_next_inst_reloc(
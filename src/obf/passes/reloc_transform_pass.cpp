@@ -45,22 +45,18 @@ void reloc_transform_pass_t::generic_pass(decomp::symbol_t* sym,
   spdlog::info("adding transformations to relocation in symbol: {}",
                sym->name());
 
-  xed_error_enum_t err;
-  xed_decoded_inst_t inst;
-  xed_state_t istate{XED_MACHINE_MODE_LONG_64, XED_ADDRESS_WIDTH_64b};
-  xed_decoded_inst_zero_set_mode(&inst, &istate);
-
-  if ((err = xed_decode(&inst, sym->data().data(), sym->data().size())) !=
-      XED_ERROR_NONE) {
-    spdlog::error("failed to decode instruction, reason: {} in symbol: {}",
-                  xed_error_enum_t2str(err), sym->name());
-
-    assert(err == XED_ERROR_NONE);
+  auto decoded = sym->decoded();
+  if (!decoded) {
+    spdlog::error("failed to decode instruction in symbol: {}", sym->name());
+    assert(decoded);
+    return;
   }
 
-  auto transforms_bytes = transform::generate(&inst, reloc.value(), 3, 6);
-  sym->data().insert(sym->data().end(), transforms_bytes.begin(),
-                     transforms_bytes.end());
+  // the decoded instruction is turned into an encoder request by the
+  // transformations so a copy is handed to them...
+  //
+  xed_decoded_inst_t inst = *decoded;
+  sym->append(transform::generate(&inst, reloc.value(), 3, 6));
 };
 
 std::optional<recomp::reloc_t*> reloc_transform_pass_t::has_legit_reloc(
@@ -38,167 +38,200 @@ recomp_t::recomp_t(decomp::decomp_t* dcmp,
     : m_dcmp(dcmp), m_allocator(alloc), m_copier(copy), m_resolver(resolve) {}
 
 void recomp_t::allocate() {
-  // map code & data/rdata/bss sections first...
+  // the loops below read the hot columns of the symbol table and only touch a
+  // symbol when a pass runs on it or its section has to be looked up...
+  //
+  auto syms = m_dcmp->syms();
+  auto& hot = syms->hot();
+
+  // every link allocates every symbol again, symbols that are kept between
+  // links (see decomp_t::redecompose) still have their previous address...
   //
+  for (auto row = 0u; row < hot.syms.size(); ++row)
+    if (hot.allocs[row])
+      syms->allocated_at(row, 0);
+
   static const auto engine = obf::engine_t::get();
-  m_dcmp->syms()->for_each([&](theo::decomp::symbol_t& sym) {
-    switch (sym.type()) {
-      case decomp::sym_type_t::section:
-      case decomp::sym_type_t::function:
-      case decomp::sym_type_t::instruction: {
-        engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-          if (sym->allocated_at())
-            return;
-
-          auto res = pass->allocation_pass(sym, sym->size(), m_allocator);
-          if (res.has_value())
-            sym->allocated_at(res.value());
-        });
-
-        if (!sym.allocated_at())
-          sym.allocated_at(m_allocator(sym.size(), sym.scn()->characteristics));
-        break;
-      }
-      default:
-        break;
-    }
-  });
+  const auto allocate_row = [&](std::uint32_t row,
+                                coff::section_characteristics_t prot) {
+    std::uintptr_t addr = 0;
+    engine->for_each(hot.syms[row], hot.types[row],
+                     [&](decomp::symbol_t* sym, obf::pass_t* pass) {
+                       if (addr)
+                         return;
+
+                       auto res = pass->allocation_pass(sym, hot.sizes[row],
+                                                        m_allocator);
+                       if (res.has_value())
+                         addr = res.value();
+                     });
+
+    if (!addr)
+      addr = m_allocator(hot.sizes[row], prot);
+
+    syms->allocated_at(row, addr);
+  };
+
+  // map code & data/rdata/bss sections first...
+  //
+  for (auto row = 0u; row < hot.syms.size(); ++row)
+    if (hot.types[row] & (decomp::sym_type_t::section |
+                          decomp::sym_type_t::function |
+                          decomp::sym_type_t::instruction))
+      allocate_row(row, hot.chars[row]);
 
   // then map data/rdata/bss symbols to the allocated sections...
   //
-  m_dcmp->syms()->for_each([&](theo::decomp::symbol_t& sym) {
-    if (sym.type() == decomp::sym_type_t::data) {
-      // if the symbol has a section then we will refer to the allocation made
-      // for that section...
-      //
-      if (sym.scn()) {
-        auto scn_sym =
-            m_dcmp->syms()->sym_from_hash(m_dcmp->scn_hash_tbl()[sym.scn()]);
-
-        if (!scn_sym.has_value()) {
-          spdlog::error("failed to locate section: {} for symbol: {}",
-                        sym.scn()->name.to_string(), sym.name());
-
-          assert(scn_sym.has_value());
-        }
-
-        sym.allocated_at(scn_sym.value()->allocated_at() + sym.offset());
-      } else {  // else if there is no section then we allocate based upon the
-                // size of the symbol... this is only done for symbols that are
-                // bss...
-                //
-
-        // bss is read write...
-        //
-        coff::section_characteristics_t prot = {};
-        prot.mem_read = true;
-        prot.mem_write = true;
-
-        engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-          if (sym->allocated_at())
-            return;
-
-          auto res = pass->allocation_pass(sym, sym->size(), m_allocator);
-          if (res.has_value())
-            sym->allocated_at(res.value());
-        });
-
-        if (!sym.allocated_at())
-          sym.allocated_at(m_allocator(sym.size(), sym.scn()->characteristics));
+  auto pool = decomp::name_pool_t::get();
+  for (auto row = 0u; row < hot.syms.size(); ++row) {
+    if (hot.types[row] != decomp::sym_type_t::data)
+      continue;
+
+    // if the symbol has a section then we will refer to the allocation made
+    // for that section...
+    //
+    auto sym = hot.syms[row];
+    if (sym->scn_name() != decomp::no_name) {
+      auto scn_row = syms->row_of(pool->hash(sym->scn_name()));
+      if (!scn_row.has_value()) {
+        spdlog::error("failed to locate section: {} for symbol: {}",
+                      pool->name(sym->scn_name()), sym->name());
+
+        assert(scn_row.has_value());
+        continue;
       }
+
+      syms->allocated_at(row, hot.allocs[scn_row.value()] + sym->offset());
+    } else {  // else if there is no section then we allocate based upon
+              // the size of the symbol... this is only done for symbols
+              // that are bss...
+              //
+
+      // bss is read write...
+      //
+      coff::section_characteristics_t prot = {};
+      prot.mem_read = true;
+      prot.mem_write = true;
+      allocate_row(row, prot);
     }
-  });
+  }
+
+  // every symbol has its address now, index them for reverse lookups...
+  //
+  syms->index_allocs();
 }
 
 void recomp_t::resolve() {
+  auto syms = m_dcmp->syms();
+  auto& hot = syms->hot();
+  static const auto engine = obf::engine_t::get();
+
   // resolve relocations in all symbols...
   //
-  m_dcmp->syms()->for_each([&](theo::decomp::symbol_t& sym) {
-    auto& relocs = sym.relocs();
-    std::for_each(relocs.begin(), relocs.end(), [&](reloc_t& reloc) {
-      if (reloc.offset() > sym.data().size()) {
+  for (auto row = 0u; row < hot.syms.size(); ++row) {
+    if (hot.relocs[row].empty())
+      continue;
+
+    // only sections, functions and instructions have their relocations
+    // written, the data is taken for modification once per symbol...
+    //
+    auto type = hot.types[row];
+    auto writes = type == decomp::sym_type_t::section ||
+                  type == decomp::sym_type_t::function ||
+                  type == decomp::sym_type_t::instruction;
+
+    auto data = writes ? syms->data(row).data() : nullptr;
+    auto size = hot.sizes[row];
+
+    for (auto& reloc : hot.relocs[row]) {
+      if (reloc.offset() > size) {
         spdlog::error(
             "invalid relocation... writing outside of symbol length... offset: "
             "{} sym size: {}",
-            sym.offset(), sym.data().size());
+            reloc.offset(), size);
 
-        assert(reloc.offset() > sym.data().size());
+        assert(reloc.offset() <= size);
+        continue;
       }
 
       // try and resolve the symbol by refering to the internal symbol table
       // first... if there is no symbol then refer to the resolver...
       //
-      auto reloc_sym = m_dcmp->syms()->sym_from_hash(reloc.hash());
-      auto allocated_at = reloc_sym.has_value()
-                              ? reloc_sym.value()->allocated_at()
-                              : m_resolver(reloc.name());
+      auto reloc_row = syms->row_of(reloc.hash());
+      auto allocated_at = reloc_row.has_value()
+                              ? hot.allocs[reloc_row.value()]
+                              : m_resolver(std::string(reloc.name()));
 
       // run passes related to post symbol relocation...
       //
-      static const auto engine = obf::engine_t::get();
-      engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-        auto res = pass->resolver_pass(sym, &reloc, allocated_at);
-        if (res.has_value())
-          allocated_at = res.value();
-      });
+      auto ran = engine->for_each(
+          hot.syms[row], type, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
+            auto res = pass->resolver_pass(sym, &reloc, allocated_at);
+            if (res.has_value())
+              allocated_at = res.value();
+          });
 
       if (!allocated_at) {
         spdlog::error("failed to resolve reloc from symbol: {} to symbol: {}",
-                      sym.name(), reloc.name());
+                      hot.syms[row]->name(), reloc.name());
 
         assert(allocated_at);
       }
 
-      switch (sym.type()) {
-        case decomp::sym_type_t::section: {
-          auto scn_sym =
-              m_dcmp->syms()->sym_from_hash(m_dcmp->scn_hash_tbl()[sym.scn()]);
-
-          *reinterpret_cast<std::uintptr_t*>(scn_sym.value()->data().data() +
-                                             reloc.offset()) = allocated_at;
-          break;
-        }
-        case decomp::sym_type_t::instruction: {
-          auto& transforms = reloc.get_transforms();
-          std::for_each(
-              transforms.begin(), transforms.end(),
-              [&](std::pair<obf::transform::transform_t*, std::uint32_t>& t) {
-                allocated_at = (*t.first)(allocated_at, t.second);
-              });
-
-          *reinterpret_cast<std::uintptr_t*>(sym.data().data() +
-                                             reloc.offset()) = allocated_at;
-          break;
-        }
-        case decomp::sym_type_t::function: {
-          *reinterpret_cast<std::uintptr_t*>(sym.data().data() +
-                                             reloc.offset()) = allocated_at;
-          break;
-        }
-        default:
-          break;
-      }
-    });
-  });
+      if (!writes)
+        continue;
+
+      // a resolver pass may have changed the data of the symbol...
+      //
+      if (ran)
+        data = syms->data(row).data();
+
+      if (type == decomp::sym_type_t::instruction)
+        for (auto& [transform, imm] : reloc.get_transforms())
+          allocated_at = (*transform)(allocated_at, imm);
+
+      *reinterpret_cast<std::uintptr_t*>(data + reloc.offset()) = allocated_at;
+    }
+  }
 }
 
 void recomp_t::copy_syms() {
-  // copy symbols into memory using the copier supplied...
-  //
+  auto syms = m_dcmp->syms();
+  auto& hot = syms->hot();
   static const auto engine = obf::engine_t::get();
-  m_dcmp->syms()->for_each([&](theo::decomp::symbol_t& sym) {
-    bool cpy = false;
-    engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-      if (cpy)
-        return;
-      // returns true if the copy was done for this symbol...
-      //
-      cpy = pass->copier_pass(sym, m_copier);
-    });
 
-    if (!cpy)
-      m_copier(sym.allocated_at(), sym.data().data(), sym.data().size());
-  });
+  // copy symbols into memory using the copier supplied. the copier passes run
+  // first and record in the copied column of each row whether they copied
+  // the symbol. a pass that did not copy the symbol may still have changed
+  // it, so its row is refreshed...
+  //
+  for (auto row = 0u; row < hot.syms.size(); ++row) {
+    if (!hot.syms[row])
+      continue;
+
+    bool cpy = false;
+    auto ran = engine->for_each(hot.syms[row], hot.types[row],
+                                [&](decomp::symbol_t* sym, obf::pass_t* pass) {
+                                  if (cpy)
+                                    return;
+                                  // returns true if the copy was done for
+                                  // this symbol...
+                                  //
+                                  cpy = pass->copier_pass(sym, m_copier);
+                                });
+
+    syms->copied(row, cpy);
+    if (ran && !cpy)
+      syms->refresh(row);
+  }
+
+  // copy the rest straight out of the symbols bytes, which may be a view into
+  // the mapped lib file...
+  //
+  for (auto row = 0u; row < hot.syms.size(); ++row)
+    if (hot.syms[row] && !hot.copied[row])
+      m_copier(hot.allocs[row], const_cast<std::uint8_t*>(hot.data[row]),
+               hot.sizes[row]);
 }
 
 void recomp_t::allocator(allocator_t alloc) {
@@ -29,51 +29,525 @@
 //
 
 #include <recomp/symbol_table.hpp>
+#include <spdlog/spdlog.h>
+
+#include <bit>
+#include <iterator>
+#include <new>
 
 namespace theo::recomp {
-symbol_table_t::symbol_table_t(const std::vector<decomp::symbol_t>&& syms) {
-  std::for_each(syms.begin(), syms.end(), [&](decomp::symbol_t sym) {
-    m_table.insert({sym.hash(), sym});
-  });
+symbol_table_t::symbol_table_t(std::vector<decomp::symbol_t>&& syms)
+    : m_size(0),
+      m_num_erased(0),
+      m_allocs_stale(true),
+      m_types_stale(false) {
+  for (auto& sym : syms)
+    insert(std::move(sym));
+}
+
+symbol_table_t::~symbol_table_t() {
+  for (auto idx = 0u; idx < m_size.load(); ++idx) {
+    if (erased(idx))
+      continue;
+
+    release(at(idx));
+    at(idx).~symbol_t();
+  }
+}
+
+void symbol_table_t::release(decomp::symbol_t& sym) {
+  // the transformation chains of a relocation belong to it alone...
+  //
+  for (auto& reloc : sym.relocs())
+    reloc.release_transforms();
+}
+
+decomp::symbol_t* symbol_table_t::put_symbol(decomp::symbol_t&& sym) {
+  return insert(std::move(sym));
+}
+
+bool symbol_table_t::put_symbols(std::vector<decomp::symbol_t>&& syms) {
+  auto res = true;
+  for (auto& sym : syms)
+    res &= insert(std::move(sym)) != nullptr;
+
+  return res;
+}
+
+decomp::symbol_t* symbol_table_t::replace(decomp::symbol_t&& sym) {
+  auto& shard = shard_of(sym.hash());
+  std::unique_lock<std::shared_mutex> lock(shard.mtx);
+
+  auto& slot = find_slot(shard, sym.hash());
+  if (!slot.idx)
+    return emplace(shard, slot, std::move(sym));
+
+  // func_split_pass_t replaces a function with its first instruction. the old
+  // entry in the index of the previous type is skipped when visited and is
+  // removed the next time the indices are rebuilt...
+  //
+  auto& res = at(slot.idx - 1);
+  if (res.name_id() != sym.name_id()) {
+    spdlog::error("[symbol_table_t] hash collision between {} and {}",
+                  res.name(), sym.name());
+    return nullptr;
+  }
+
+  auto prev_type = res.type();
+  release(res);
+  res = std::move(sym);
+  m_allocs_stale = true;
+  {
+    std::lock_guard<std::mutex> arena_lock(m_arena_mtx);
+    hot_row(slot.idx - 1);
+  }
+
+  if (res.type() != prev_type) {
+    std::lock_guard<std::mutex> types_lock(m_types_mtx);
+    index_type(slot.idx - 1, res.type());
+    m_types_stale = true;
+  }
+
+  return &res;
+}
+
+decomp::symbol_t* symbol_table_t::insert(decomp::symbol_t&& sym) {
+  auto& shard = shard_of(sym.hash());
+  std::unique_lock<std::shared_mutex> lock(shard.mtx);
+
+  auto& slot = find_slot(shard, sym.hash());
+  if (!slot.idx)
+    return emplace(shard, slot, std::move(sym));
+
+  // the same symbol being added twice is fine, the first one is kept. a
+  // different name with the same hash is a collision...
+  //
+  auto& res = at(slot.idx - 1);
+  if (res.name_id() != sym.name_id()) {
+    spdlog::error("[symbol_table_t] hash collision between {} and {}",
+                  res.name(), sym.name());
+    return nullptr;
+  }
+
+  return &res;
+}
+
+bool symbol_table_t::erase(std::size_t hash) {
+  auto& shard = shard_of(hash);
+  std::unique_lock<std::shared_mutex> lock(shard.mtx);
+  if (shard.slots.empty())
+    return false;
+
+  auto mask = shard.slots.size() - 1;
+  auto pos = hash & mask;
+  for (; shard.slots[pos].idx; pos = (pos + 1) & mask)
+    if (shard.slots[pos].hash == hash)
+      break;
+
+  if (!shard.slots[pos].idx)
+    return false;
+
+  auto idx = shard.slots[pos].idx - 1;
+
+  // shift the entries that follow back into the hole so that no probe
+  // sequence is broken. an entry moves if the hole lies between its home slot
+  // and where it is now...
+  //
+  for (auto next = (pos + 1) & mask; shard.slots[next].idx;
+       next = (next + 1) & mask) {
+    auto home = shard.slots[next].hash & mask;
+    if (((next - home) & mask) >= ((next - pos) & mask)) {
+      shard.slots[pos] = shard.slots[next];
+      pos = next;
+    }
+  }
+
+  shard.slots[pos] = {};
+  --shard.used;
+
+  {
+    std::lock_guard<std::mutex> types_lock(m_types_mtx);
+    m_type_of[idx] = {};
+    m_types_stale = true;
+  }
+
+  if (idx >= m_erased.size())
+    m_erased.resize(m_size.load());
+
+  m_erased[idx] = true;
+  ++m_num_erased;
+  release(at(idx));
+  at(idx).~symbol_t();
+  m_allocs_stale = true;
+
+  // the row of the symbol is kept so the rows of the other symbols dont
+  // move...
+  //
+  std::lock_guard<std::mutex> arena_lock(m_arena_mtx);
+  m_hot.syms[idx] = nullptr;
+  m_hot.types[idx] = {};
+  m_hot.sizes[idx] = 0;
+  m_hot.allocs[idx] = 0;
+  m_hot.data[idx] = nullptr;
+  m_hot.relocs[idx] = {};
+  return true;
+}
+
+bool symbol_table_t::erased(std::uint32_t idx) {
+  return idx < m_erased.size() && m_erased[idx];
+}
+
+symbol_table_t::shard_t& symbol_table_t::shard_of(std::size_t hash) {
+  // the low bits of the hash pick the slot inside of the shard so the shard
+  // is picked by the top bits...
+  //
+  return m_shards[static_cast<std::uint64_t>(hash) >>
+                  (64 - std::countr_zero(num_shards))];
+}
+
+symbol_table_t::slot_t& symbol_table_t::find_slot(shard_t& shard,
+                                                  std::size_t hash) {
+  // keep the shard at most half full so that probe sequences stay short...
+  //
+  if ((shard.used + 1) * 2 > shard.slots.size())
+    grow(shard);
+
+  auto mask = shard.slots.size() - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    auto& slot = shard.slots[pos];
+    if (!slot.idx || slot.hash == hash)
+      return slot;
+  }
+}
+
+decomp::symbol_t& symbol_table_t::at(std::uint32_t idx) {
+  auto [seg, pos] = util::segment_of(idx, seg_base);
+  return *std::launder(
+      reinterpret_cast<decomp::symbol_t*>(m_segs[seg][pos].data));
+}
+
+decomp::symbol_t* symbol_table_t::emplace(shard_t& shard,
+                                          slot_t& slot,
+                                          decomp::symbol_t&& sym) {
+  std::uint32_t idx;
+  decomp::symbol_t* res;
+  {
+    // the arena is appended to in order so that every index below m_size is a
+    // constructed symbol. m_size is published last, readers that load it see
+    // the symbols and the segments that hold them...
+    //
+    std::lock_guard<std::mutex> lock(m_arena_mtx);
+    idx = m_size.load(std::memory_order_relaxed);
+
+    // the index of a symbol is stored plus one in 32 bits...
+    //
+    if (idx >= max_syms) {
+      spdlog::error("[symbol_table_t] arena is full, {} symbols", idx);
+      return nullptr;
+    }
+
+    auto [seg, pos] = util::segment_of(idx, seg_base);
+    if (!m_segs[seg])
+      m_segs[seg] = std::make_unique_for_overwrite<storage_t[]>(
+          util::segment_size(seg, seg_base));
+
+    res = new (m_segs[seg][pos].data) decomp::symbol_t(std::move(sym));
+    m_hot.syms.resize(idx + 1);
+    m_hot.types.resize(idx + 1);
+    m_hot.sizes.resize(idx + 1);
+    m_hot.allocs.resize(idx + 1);
+    m_hot.data.resize(idx + 1);
+    m_hot.relocs.resize(idx + 1);
+    m_hot.chars.resize(idx + 1);
+    m_hot.copied.resize(idx + 1);
+    hot_row(idx);
+    m_size.store(idx + 1, std::memory_order_release);
+  }
+
+  slot = {res->hash(), idx + 1};
+  ++shard.used;
+  m_allocs_stale = true;
+
+  std::lock_guard<std::mutex> lock(m_types_mtx);
+  index_type(idx, res->type());
+  return res;
+}
+
+void symbol_table_t::grow(shard_t& shard) {
+  std::vector<slot_t> slots(std::max(shard.slots.size() * 2, min_slots));
+  auto mask = slots.size() - 1;
+
+  for (auto& slot : shard.slots) {
+    if (!slot.idx)
+      continue;
+
+    auto pos = slot.hash & mask;
+    while (slots[pos].idx)
+      pos = (pos + 1) & mask;
+
+    slots[pos] = slot;
+  }
+
+  shard.slots = std::move(slots);
 }
 
-void symbol_table_t::put_symbol(decomp::symbol_t& sym) {
-  m_table.insert({sym.hash(), sym});
+std::optional<std::uint32_t> symbol_table_t::row_at(
+    const decomp::symbol_t* sym) {
+  auto addr = reinterpret_cast<std::uintptr_t>(sym);
+  for (auto seg = 0u; seg < max_segs && m_segs[seg]; ++seg) {
+    auto bgn = reinterpret_cast<std::uintptr_t>(m_segs[seg].get());
+    auto size = util::segment_size(seg, seg_base);
+    if (addr < bgn || addr >= bgn + size * sizeof(storage_t))
+      continue;
+
+    auto row = seg_base * ((std::size_t{1} << seg) - 1) +
+               (addr - bgn) / sizeof(storage_t);
+
+    if (row >= m_size.load(std::memory_order_relaxed))
+      return {};
+
+    return static_cast<std::uint32_t>(row);
+  }
+  return {};
 }
 
-void symbol_table_t::put_symbols(std::vector<decomp::symbol_t>& syms) {
-  std::for_each(syms.begin(), syms.end(),
-                [&](decomp::symbol_t sym) { put_symbol(sym); });
+bool symbol_table_t::hot_row(std::uint32_t idx) {
+  auto& sym = at(idx);
+  auto bytes = sym.bytes();
+  auto& relocs = sym.relocs();
+  auto retyped = m_hot.types[idx] != sym.type();
+
+  m_hot.syms[idx] = &sym;
+  m_hot.types[idx] = sym.type();
+  m_hot.sizes[idx] = bytes.size();
+  m_hot.allocs[idx] = sym.allocated_at();
+  m_hot.data[idx] = bytes.data();
+  m_hot.relocs[idx] = {relocs.data(), relocs.size()};
+  m_hot.chars[idx] = sym.scn_chars();
+  return retyped;
+}
+
+void symbol_table_t::index_type(std::uint32_t idx, decomp::sym_type_t type) {
+  // symbols may be indexed out of order by threads racing to add them...
+  //
+  if (idx >= m_type_of.size())
+    m_type_of.resize(idx + 1);
+
+  m_type_of[idx] = type;
+  if (type)
+    m_types[std::countr_zero(static_cast<std::uint32_t>(type))].push_back(idx);
 }
 
 void symbol_table_t::for_each(std::function<void(decomp::symbol_t& sym)> fn) {
-  for (auto itr = m_table.begin(); itr != m_table.end(); ++itr)
-    fn(itr->second);
+  // only the symbols that were in the table when the traversal began are
+  // visited. the symbols never move so the reference stays valid...
+  //
+  auto size = m_size.load(std::memory_order_acquire);
+  for (auto idx = 0u; idx < size; ++idx)
+    if (!erased(idx))
+      fn(at(idx));
+}
+
+void symbol_table_t::for_each(std::uint32_t types,
+                              std::function<void(decomp::symbol_t& sym)> fn) {
+  for_each(types, 0, fn);
+}
+
+void symbol_table_t::for_each(std::uint32_t types,
+                              std::uint32_t from,
+                              std::function<void(decomp::symbol_t& sym)> fn) {
+  std::array<std::vector<std::uint32_t>, num_types> snap;
+  {
+    // drop the entries left behind by symbols that changed type, then copy
+    // the requested indices so other threads can keep adding to them...
+    //
+    std::lock_guard<std::mutex> lock(m_types_mtx);
+    if (m_types_stale) {
+      for (auto& syms : m_types)
+        syms.clear();
+
+      for (auto idx = 0u; idx < m_type_of.size(); ++idx)
+        if (m_type_of[idx])
+          m_types[std::countr_zero(static_cast<std::uint32_t>(
+                      m_type_of[idx]))]
+              .push_back(idx);
+
+      m_types_stale = false;
+    }
+
+    for (auto type = 0u; type < num_types; ++type)
+      if (types & (1u << type))
+        std::copy_if(m_types[type].begin(), m_types[type].end(),
+                     std::back_inserter(snap[type]),
+                     [&](std::uint32_t idx) { return idx >= from; });
+  }
+
+  for (auto type = 0u; type < num_types; ++type) {
+    // indices added out of order are sorted so symbols are still visited in
+    // the order they were added...
+    //
+    std::sort(snap[type].begin(), snap[type].end());
+    for (auto idx : snap[type]) {
+      if (erased(idx))
+        continue;
+
+      auto& sym = at(idx);
+      if (sym.type() == (1u << type))
+        fn(sym);
+    }
+  }
 }
 
 std::optional<decomp::symbol_t*> symbol_table_t::sym_from_hash(
     std::size_t hash) {
-  return m_table.count(hash) ? &m_table.at(hash)
-                             : std::optional<decomp::symbol_t*>{};
+  auto row = row_of(hash);
+  return row.has_value() ? &at(row.value())
+                         : std::optional<decomp::symbol_t*>{};
+}
+
+std::optional<std::uint32_t> symbol_table_t::row_of(std::size_t hash) {
+  auto& shard = shard_of(hash);
+  std::shared_lock<std::shared_mutex> lock(shard.mtx);
+  if (shard.slots.empty())
+    return {};
+
+  auto mask = shard.slots.size() - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    auto& slot = shard.slots[pos];
+    if (!slot.idx)
+      return {};
+
+    if (slot.hash == hash)
+      return slot.idx - 1;
+  }
 }
 
 std::optional<decomp::symbol_t*> symbol_table_t::sym_from_alloc(
     std::uintptr_t allocated_at) {
-  auto res =
-      std::find_if(m_table.begin(), m_table.end(),
-                   [&](std::pair<const std::size_t, decomp::symbol_t> itr) {
-                     return itr.second.allocated_at() == allocated_at;
-                   });
+  if (m_allocs_stale)
+    index_allocs();
+
+  auto itr = std::lower_bound(
+      m_allocs.begin(), m_allocs.end(), allocated_at,
+      [](const alloc_t& a, std::uintptr_t addr) { return a.bgn < addr; });
+
+  return itr != m_allocs.end() && itr->bgn == allocated_at
+             ? itr->sym
+             : std::optional<decomp::symbol_t*>{};
+}
+
+std::optional<std::pair<decomp::symbol_t*, std::uintptr_t>>
+symbol_table_t::sym_from_addr(std::uintptr_t addr) {
+  if (m_allocs_stale)
+    index_allocs();
+
+  // the last symbol that starts at or before the address...
+  //
+  auto itr = std::upper_bound(
+      m_extents.begin(), m_extents.end(), addr,
+      [](std::uintptr_t addr, const alloc_t& a) { return addr < a.bgn; });
+
+  if (itr == m_extents.begin() || addr >= (--itr)->end)
+    return {};
+
+  return {{itr->sym, addr - itr->bgn}};
+}
+
+const hot_syms_t& symbol_table_t::hot() {
+  return m_hot;
+}
+
+void symbol_table_t::refresh(std::span<decomp::symbol_t* const> syms) {
+  // the rows are found from the addresses of the symbols, which is much
+  // cheaper than looking up their names...
+  //
+  // symbols of a batch are mostly next to the one before them...
+  //
+  std::vector<std::uint32_t> retyped;
+  {
+    std::lock_guard<std::mutex> lock(m_arena_mtx);
+    std::optional<std::uint32_t> row;
+    for (auto sym : syms) {
+      auto next = row.has_value() ? row.value() + 1 : 0;
+      if (row.has_value() && util::segment_of(next, seg_base).second &&
+          next < m_size.load(std::memory_order_relaxed) && sym == &at(next))
+        row = next;
+      else
+        row = row_at(sym);
+
+      if (row.has_value() && m_hot.syms[row.value()] && hot_row(row.value()))
+        retyped.push_back(row.value());
+    }
+  }
+
+  m_allocs_stale = true;
+  if (retyped.empty())
+    return;
+
+  // a pass changed the type of a symbol without replacing it...
+  //
+  std::lock_guard<std::mutex> lock(m_types_mtx);
+  for (auto row : retyped)
+    index_type(row, at(row).type());
+
+  m_types_stale = true;
+}
+
+void symbol_table_t::refresh(std::uint32_t row) {
+  auto sym = &at(row);
+  refresh({&sym, 1});
+}
 
-  return res != m_table.end() ? &res->second
-                              : std::optional<decomp::symbol_t*>{};
+void symbol_table_t::allocated_at(std::uint32_t row,
+                                  std::uintptr_t allocated_at) {
+  m_hot.allocs[row] = allocated_at;
+  m_hot.syms[row]->allocated_at(allocated_at);
+  m_allocs_stale = true;
 }
 
-std::map<std::size_t, decomp::symbol_t>& symbol_table_t::get() {
-  return m_table;
+decomp::bytes_t& symbol_table_t::data(std::uint32_t row) {
+  auto& res = m_hot.syms[row]->data();
+  m_hot.data[row] = res.data();
+  m_hot.sizes[row] = res.size();
+  return res;
+}
+
+void symbol_table_t::copied(std::uint32_t row, bool copied) {
+  m_hot.copied[row] = copied;
+}
+
+void symbol_table_t::index_allocs() {
+  m_allocs.clear();
+  m_extents.clear();
+
+  for (auto idx = 0u; idx < m_hot.syms.size(); ++idx) {
+    if (!m_hot.syms[idx] || !m_hot.allocs[idx])
+      continue;
+
+    alloc_t alloc = {m_hot.allocs[idx], m_hot.allocs[idx] + m_hot.sizes[idx],
+                     idx, m_hot.syms[idx]};
+    m_allocs.push_back(alloc);
+    if (m_hot.sizes[idx])
+      m_extents.push_back(alloc);
+  }
+
+  // ties are broken by the order of the symbols so lookups are
+  // deterministic...
+  //
+  const auto by_bgn = [](const alloc_t& a, const alloc_t& b) {
+    return a.bgn != b.bgn ? a.bgn < b.bgn : a.idx < b.idx;
+  };
+
+  std::sort(m_allocs.begin(), m_allocs.end(), by_bgn);
+  std::sort(m_extents.begin(), m_extents.end(), by_bgn);
+  m_allocs_stale = false;
 }
 
 std::uint32_t symbol_table_t::size() {
-  return m_table.size();
+  return m_size.load(std::memory_order_acquire) - m_num_erased;
+}
+
+std::uint32_t symbol_table_t::watermark() {
+  return m_size.load(std::memory_order_acquire);
 }
-}  // namespace theo::recomp
\ No newline at end of file
+}  // namespace theo::recomp
@@ -0,0 +1,290 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <recomp/table_file.hpp>
+#include <spdlog/spdlog.h>
+#include <util/hash.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace theo::recomp {
+namespace {
+// index of a name record meaning the symbol has no such name...
+//
+constexpr std::uint32_t no_rec = ~0u;
+
+constexpr std::uint64_t align8(std::uint64_t val) {
+  return (val + 7) & ~7ull;
+}
+
+bool in_bounds(std::uint64_t off,
+               std::uint64_t count,
+               std::uint64_t elem,
+               std::uint64_t size) {
+  return off <= size && count <= (size - off) / elem;
+}
+}  // namespace
+
+table_file_t::table_file_t(const std::filesystem::path& path) {
+  // a missing file is the common case on a cold start, it is not an error...
+  //
+  std::error_code ec;
+  if (std::filesystem::exists(path, ec))
+    m_map = std::make_unique<decomp::file_map_t>(path);
+}
+
+bool table_file_t::load(std::uint64_t key, symbol_table_t* tbl) {
+  if (!m_map || m_map->data().size() < sizeof(header_t))
+    return false;
+
+  // the mapping is page aligned and every record is at an aligned offset so
+  // the records are read in place...
+  //
+  auto file = m_map->data();
+  auto hdr = reinterpret_cast<const header_t*>(file.data());
+  if (hdr->magic != magic || hdr->version != version) {
+    spdlog::warn("[table_file_t] ignoring table file of another version...");
+    return false;
+  }
+
+  if (hdr->key != key)
+    return false;
+
+  auto size = file.size();
+  if (hdr->size != size ||
+      !in_bounds(hdr->syms, hdr->num_syms, sizeof(sym_rec_t), size) ||
+      !in_bounds(hdr->relocs, hdr->num_relocs, sizeof(reloc_rec_t), size) ||
+      !in_bounds(hdr->names, hdr->num_names, sizeof(name_rec_t), size) ||
+      !in_bounds(hdr->strs, hdr->strs_size, 1, size) ||
+      !in_bounds(hdr->data, hdr->data_size, 1, size)) {
+    spdlog::error("[table_file_t] table file is truncated or malformed...");
+    return false;
+  }
+
+  auto syms = reinterpret_cast<const sym_rec_t*>(file.data() + hdr->syms);
+  auto relocs =
+      reinterpret_cast<const reloc_rec_t*>(file.data() + hdr->relocs);
+  auto names = reinterpret_cast<const name_rec_t*>(file.data() + hdr->names);
+  auto strs = reinterpret_cast<const char*>(file.data() + hdr->strs);
+  auto data = file.data() + hdr->data;
+
+  // check every record before anything is added to the table...
+  //
+  const auto valid_name = [&](std::uint32_t name) {
+    return name < hdr->num_names;
+  };
+
+  for (auto idx = 0u; idx < hdr->num_names; ++idx) {
+    if (!in_bounds(names[idx].offset, names[idx].size, 1, hdr->strs_size)) {
+      spdlog::error("[table_file_t] name {} is out of bounds...", idx);
+      return false;
+    }
+  }
+
+  for (auto idx = 0u; idx < hdr->num_relocs; ++idx) {
+    if (!valid_name(relocs[idx].name)) {
+      spdlog::error("[table_file_t] relocation {} is malformed...", idx);
+      return false;
+    }
+  }
+
+  for (auto idx = 0u; idx < hdr->num_syms; ++idx) {
+    auto& rec = syms[idx];
+    if (!valid_name(rec.name) ||
+        (rec.scn_name != no_rec && !valid_name(rec.scn_name)) ||
+        !in_bounds(rec.reloc, rec.num_relocs, 1, hdr->num_relocs) ||
+        !in_bounds(rec.data, rec.size, 1, hdr->data_size) ||
+        !(rec.type & decomp::sym_type_t::all)) {
+      spdlog::error("[table_file_t] symbol {} is malformed...", idx);
+      return false;
+    }
+  }
+
+  // name ids are only meaningful inside of a process, so the names are
+  // interned again...
+  //
+  auto pool = decomp::name_pool_t::get();
+  std::vector<decomp::name_id_t> ids(hdr->num_names);
+  for (auto idx = 0u; idx < hdr->num_names; ++idx)
+    ids[idx] = pool->intern({strs + names[idx].offset, names[idx].size});
+
+  std::vector<std::size_t> added;
+  for (auto idx = 0u; idx < hdr->num_syms; ++idx) {
+    auto& rec = syms[idx];
+    decomp::relocs_t sym_relocs;
+    for (auto pos = rec.reloc; pos < rec.reloc + rec.num_relocs; ++pos)
+      sym_relocs.push_back(reloc_t(relocs[pos].offset, ids[relocs[pos].name]));
+
+    decomp::symbol_t sym(nullptr, ids[rec.name], rec.offset,
+                         {data + rec.data, rec.size}, nullptr, nullptr,
+                         std::move(sym_relocs),
+                         static_cast<decomp::sym_type_t>(rec.type));
+
+    coff::section_characteristics_t chars = {};
+    chars.flags = rec.scn_chars;
+    sym.scn_chars(chars);
+
+    if (rec.scn_name != no_rec)
+      sym.scn_name(ids[rec.scn_name]);
+
+    // a symbol that collides with another symbol fails the load, the
+    // symbols added before it are taken out again...
+    //
+    auto watermark = tbl->watermark();
+    auto res = tbl->put_symbol(std::move(sym));
+    if (!res) {
+      spdlog::error("[table_file_t] symbol {} could not be added...", idx);
+      for (auto hash : added)
+        tbl->erase(hash);
+
+      return false;
+    }
+
+    if (tbl->watermark() != watermark)
+      added.push_back(res->hash());
+  }
+
+  spdlog::info("[table_file_t] loaded {} symbols...", hdr->num_syms);
+  return true;
+}
+
+bool table_file_t::save(const std::filesystem::path& path,
+                        std::uint64_t key,
+                        symbol_table_t* tbl) {
+  auto pool = decomp::name_pool_t::get();
+  std::vector<sym_rec_t> syms;
+  std::vector<reloc_rec_t> relocs;
+  std::vector<name_rec_t> names;
+  std::string strs;
+  std::vector<std::uint8_t> data;
+  std::unordered_map<decomp::name_id_t, std::uint32_t> name_recs;
+
+  // every distinct name is written once...
+  //
+  const auto add_name = [&](decomp::name_id_t id) -> std::uint32_t {
+    if (id == decomp::no_name)
+      return no_rec;
+
+    auto [itr, added] = name_recs.try_emplace(id, names.size());
+    if (added) {
+      auto name = pool->name(id);
+      names.push_back({static_cast<std::uint32_t>(strs.size()),
+                       static_cast<std::uint32_t>(name.size())});
+      strs.append(name);
+    }
+    return itr->second;
+  };
+
+  tbl->for_each([&](decomp::symbol_t& sym) {
+    auto bytes = sym.bytes();
+    sym_rec_t rec = {};
+    rec.offset = sym.offset();
+    rec.data = data.size();
+    rec.size = bytes.size();
+    rec.name = add_name(sym.name_id());
+    rec.scn_name = add_name(sym.scn_name());
+    rec.type = sym.type();
+    rec.scn_chars = sym.scn_chars().flags;
+    rec.reloc = relocs.size();
+    rec.num_relocs = sym.relocs().size();
+
+    for (auto& reloc : sym.relocs())
+      relocs.push_back({reloc.offset(), add_name(reloc.name_id())});
+
+    data.insert(data.end(), bytes.begin(), bytes.end());
+    syms.push_back(rec);
+  });
+
+  header_t hdr = {};
+  hdr.magic = magic;
+  hdr.version = version;
+  hdr.key = key;
+  hdr.num_syms = syms.size();
+  hdr.num_relocs = relocs.size();
+  hdr.num_names = names.size();
+  hdr.syms = align8(sizeof(header_t));
+  hdr.relocs = align8(hdr.syms + syms.size() * sizeof(sym_rec_t));
+  hdr.names = align8(hdr.relocs + relocs.size() * sizeof(reloc_rec_t));
+  hdr.strs = align8(hdr.names + names.size() * sizeof(name_rec_t));
+  hdr.strs_size = strs.size();
+  hdr.data = align8(hdr.strs + strs.size());
+  hdr.data_size = data.size();
+  hdr.size = hdr.data + data.size();
+
+  std::vector<std::uint8_t> file(hdr.size);
+  std::memcpy(file.data(), &hdr, sizeof(hdr));
+  std::memcpy(file.data() + hdr.syms, syms.data(),
+              syms.size() * sizeof(sym_rec_t));
+  std::memcpy(file.data() + hdr.relocs, relocs.data(),
+              relocs.size() * sizeof(reloc_rec_t));
+  std::memcpy(file.data() + hdr.names, names.data(),
+              names.size() * sizeof(name_rec_t));
+  std::memcpy(file.data() + hdr.strs, strs.data(), strs.size());
+  std::memcpy(file.data() + hdr.data, data.data(), data.size());
+
+  // write next to the file then rename it into place so that another process
+  // never maps a partially written file...
+  //
+  auto tmp = path;
+  tmp += ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+    if (!out) {
+      spdlog::error("[table_file_t] failed to write table file: {}",
+                    tmp.string());
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    spdlog::error("[table_file_t] failed to rename table file: {} ({})",
+                  path.string(), ec.message());
+    return false;
+  }
+
+  spdlog::info("[table_file_t] saved {} symbols to: {}", syms.size(),
+               path.string());
+  return true;
+}
+
+std::uint64_t table_file_t::key(std::span<const std::uint8_t> lib,
+                                std::string_view entry_sym) {
+  auto lib_hash = util::hash64(
+      {reinterpret_cast<const char*>(lib.data()), lib.size()}, version);
+  return util::hash64(entry_sym, lib_hash);
+}
+}  // namespace theo::recomp
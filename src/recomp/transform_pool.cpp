@@ -0,0 +1,101 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <recomp/transform_pool.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace theo::recomp {
+transform_pool_t* transform_pool_t::get() {
+  static transform_pool_t obj;
+  return &obj;
+}
+
+std::uint32_t transform_pool_t::add(std::span<const transform_entry_t> chain) {
+  if (chain.empty())
+    return 0;
+
+  assert(chain.size() <= chunk_size);
+  std::lock_guard<std::mutex> lock(m_mtx);
+  m_used += chain.size();
+
+  // reuse a released chain of the same length...
+  //
+  if (chain.size() < m_free.size() && !m_free[chain.size()].empty()) {
+    auto idx = m_free[chain.size()].back();
+    m_free[chain.size()].pop_back();
+    std::copy(chain.begin(), chain.end(),
+              &m_chunks[idx / chunk_size][idx % chunk_size]);
+    return idx;
+  }
+
+  // a chain never straddles two chunks, start a new chunk if it doesnt fit...
+  //
+  if (m_size % chunk_size + chain.size() > chunk_size)
+    m_size += chunk_size - m_size % chunk_size;
+
+  auto idx = m_size;
+  assert(idx / chunk_size < max_chunks);
+
+  auto& chunk = m_chunks[idx / chunk_size];
+  if (!chunk)
+    chunk = std::make_unique<transform_entry_t[]>(chunk_size);
+
+  std::copy(chain.begin(), chain.end(), &chunk[idx % chunk_size]);
+  m_size += chain.size();
+  return idx;
+}
+
+std::span<const transform_entry_t> transform_pool_t::chain(
+    std::uint32_t idx,
+    std::uint32_t len) const {
+  if (!len)
+    return {};
+
+  return {&m_chunks[idx / chunk_size][idx % chunk_size], len};
+}
+
+void transform_pool_t::release(std::uint32_t idx, std::uint32_t len) {
+  if (!len)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_mtx);
+  if (m_free.size() <= len)
+    m_free.resize(len + 1);
+
+  m_free[len].push_back(idx);
+  m_used -= len;
+}
+
+std::size_t transform_pool_t::size() {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  return m_used;
+}
+}  // namespace theo::recomp
@@ -31,66 +31,180 @@
 #include <theo.hpp>
 
 namespace theo {
-theo_t::theo_t(std::vector<std::uint8_t>& lib,
+theo_t::theo_t(std::span<const std::uint8_t> lib,
                lnk_fns_t lnkr_fns,
                const std::string&& entry_sym)
     : m_dcmp(lib, &m_sym_tbl),
       m_recmp(&m_dcmp, {}, {}, {}),
-      m_entry_sym(entry_sym) {
+      m_entry_sym(entry_sym),
+      m_composed(0) {
   m_recmp.allocator(std::get<0>(lnkr_fns));
   m_recmp.copier(std::get<1>(lnkr_fns));
   m_recmp.resolver(std::get<2>(lnkr_fns));
 }
 
+theo_t::theo_t(const std::filesystem::path& lib,
+               lnk_fns_t lnkr_fns,
+               const std::string&& entry_sym)
+    : m_dcmp(lib, &m_sym_tbl),
+      m_recmp(&m_dcmp, {}, {}, {}),
+      m_entry_sym(entry_sym),
+      m_composed(0) {
+  m_recmp.allocator(std::get<0>(lnkr_fns));
+  m_recmp.copier(std::get<1>(lnkr_fns));
+  m_recmp.resolver(std::get<2>(lnkr_fns));
+}
+
+theo_t::theo_t(std::istream& lib,
+               lnk_fns_t lnkr_fns,
+               const std::string&& entry_sym)
+    : m_dcmp(lib, &m_sym_tbl),
+      m_recmp(&m_dcmp, {}, {}, {}),
+      m_entry_sym(entry_sym),
+      m_composed(0) {
+  m_recmp.allocator(std::get<0>(lnkr_fns));
+  m_recmp.copier(std::get<1>(lnkr_fns));
+  m_recmp.resolver(std::get<2>(lnkr_fns));
+}
+
+void theo_t::cache(const std::filesystem::path& dir) {
+  m_cache_dir = dir;
+}
+
+void theo_t::threads(std::uint32_t threads) {
+  m_dcmp.threads(threads);
+}
+
 std::optional<std::uint32_t> theo_t::decompose() {
+  m_stats.clear();
+  auto bgn = m_stats.now();
+
+  // a table cached for the same lib and entry point skips decomposition. the
+  // symbols view the mapped table file so it is kept until theo_t is
+  // destroyed...
+  //
+  std::uint64_t key = {};
+  std::filesystem::path tbl_path;
+  if (!m_cache_dir.empty() && !m_dcmp.lib().empty()) {
+    key = recomp::table_file_t::key(m_dcmp.lib(), m_entry_sym);
+    tbl_path = m_cache_dir / fmt::format("{:016x}.tbl", key);
+    m_tbl_file = std::make_unique<recomp::table_file_t>(tbl_path);
+
+    if (m_tbl_file->load(key, &m_sym_tbl)) {
+      m_stats.add({"decompose (cached)", 0, bgn, m_stats.now() - bgn, 0,
+                   m_sym_tbl.size()});
+
+      spdlog::info("loaded decomposed symbols from: {}", tbl_path.string());
+      return m_sym_tbl.size();
+    }
+
+    m_tbl_file.reset();
+  }
+
   auto res = m_dcmp.decompose(m_entry_sym);
   if (!res.has_value()) {
     spdlog::error("failed to decompose...\n");
     return {};
   }
 
+  m_stats.add({"decompose", 0, bgn, m_stats.now() - bgn, 0,
+               res.value()->size()});
+
+  if (!tbl_path.empty())
+    recomp::table_file_t::save(tbl_path, key, res.value());
+
   spdlog::info("decompose successful... {} symbols", res.value()->size());
   return res.value()->size();
 }
 
+std::optional<std::uint32_t> theo_t::redecompose(
+    const std::filesystem::path& lib) {
+  auto bgn = m_stats.now();
+  auto watermark = m_sym_tbl.watermark();
+  auto res = m_dcmp.redecompose(lib, m_entry_sym);
+  if (!res.has_value()) {
+    spdlog::error("failed to redecompose...\n");
+    return {};
+  }
+
+  m_stats.add({"redecompose", 0, bgn, m_stats.now() - bgn, 0,
+               m_sym_tbl.watermark() - watermark});
+
+  spdlog::info("redecompose successful... {} symbols", res.value()->size());
+  return res.value()->size();
+}
+
+std::optional<std::uint32_t> theo_t::redecompose(
+    std::span<const std::uint8_t> lib) {
+  auto bgn = m_stats.now();
+  auto watermark = m_sym_tbl.watermark();
+  auto res = m_dcmp.redecompose(lib, m_entry_sym);
+  if (!res.has_value()) {
+    spdlog::error("failed to redecompose...\n");
+    return {};
+  }
+
+  m_stats.add({"redecompose", 0, bgn, m_stats.now() - bgn, 0,
+               m_sym_tbl.watermark() - watermark});
+
+  spdlog::info("redecompose successful... {} symbols", res.value()->size());
+  return res.value()->size();
+}
+
 std::uintptr_t theo_t::compose() {
   auto engine = obf::engine_t::get();
-  auto& sym_tbl = m_sym_tbl.get();
 
-  // run obfuscation engine on function symbols...
+  // symbols that were composed before keep the result of the passes, only
+  // the symbols added since then are passed...
+  //
+  auto from = m_composed;
+  auto bgn = m_stats.now();
+  auto first = m_stats.all().size();
+  auto watermark = m_sym_tbl.watermark();
+
+  // run obfuscation engine on function symbols, then on the instruction
+  // symbols they were split into, then on all other symbols...
   //
-  m_sym_tbl.for_each([&](decomp::symbol_t& sym) {
-    engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-      if (sym->type() == decomp::sym_type_t::function)
-        pass->generic_pass(sym, sym_tbl);
-    });
-  });
-
-  // run obfuscation engine on instruction symbols...
+  util::stat_t passes = {"passes", 0, bgn};
+  passes.syms_visited +=
+      engine->run(m_sym_tbl, decomp::sym_type_t::function, from, &m_stats);
+  passes.syms_visited +=
+      engine->run(m_sym_tbl, decomp::sym_type_t::instruction, from, &m_stats);
+  passes.syms_visited += engine->run(
+      m_sym_tbl, decomp::sym_type_t::section | decomp::sym_type_t::data, from,
+      &m_stats);
+
+  // the engine added a stat for every pass that ran...
   //
-  m_sym_tbl.for_each([&](decomp::symbol_t& sym) {
-    engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-      if (sym->type() == decomp::sym_type_t::instruction)
-        pass->generic_pass(sym, sym_tbl);
-    });
-  });
-
-  // run obfuscation engine on all other symbols...
+  for (auto idx = first; idx < m_stats.all().size(); ++idx) {
+    passes.bytes_added += m_stats.all()[idx].bytes_added;
+    passes.relocs_added += m_stats.all()[idx].relocs_added;
+  }
+
+  passes.time_ns = m_stats.now() - bgn;
+  passes.syms_created = m_sym_tbl.watermark() - watermark;
+  m_stats.add(std::move(passes));
+  m_composed = m_sym_tbl.watermark();
+
+  // every stage of recomp visits every symbol...
   //
-  m_sym_tbl.for_each([&](decomp::symbol_t& sym) {
-    engine->for_each(&sym, [&](decomp::symbol_t* sym, obf::pass_t* pass) {
-      if (sym->type() != decomp::sym_type_t::instruction &&
-          sym->type() != decomp::sym_type_t::function)
-        pass->generic_pass(sym, sym_tbl);
-    });
-  });
-
-  m_recmp.allocate();
-  m_recmp.resolve();
-  m_recmp.copy_syms();
+  const auto recomp_stage = [&](const char* name,
+                                void (recomp::recomp_t::*stage)()) {
+    auto bgn = m_stats.now();
+    (m_recmp.*stage)();
+    m_stats.add({name, 0, bgn, m_stats.now() - bgn, m_sym_tbl.size()});
+  };
+
+  recomp_stage("allocate", &recomp::recomp_t::allocate);
+  recomp_stage("resolve", &recomp::recomp_t::resolve);
+  recomp_stage("copy", &recomp::recomp_t::copy_syms);
   return m_recmp.resolve(m_entry_sym.data());
 }
 
+const util::stats_t& theo_t::stats() const {
+  return m_stats;
+}
+
 std::uintptr_t theo_t::resolve(const std::string&& sym) {
   auto val = m_sym_tbl.sym_from_hash(decomp::symbol_t::hash(sym));
   if (!val.has_value())
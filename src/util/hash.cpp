@@ -0,0 +1,125 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <util/hash.hpp>
+
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace theo::util {
+namespace {
+constexpr std::uint64_t secret[] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull};
+
+// multiplies a and b into 128 bits, a gets the low half and b the high half...
+//
+void mum(std::uint64_t& a, std::uint64_t& b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  a = _umul128(a, b, &b);
+#else
+  auto res = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<std::uint64_t>(res);
+  b = static_cast<std::uint64_t>(res >> 64);
+#endif
+}
+
+std::uint64_t mix(std::uint64_t a, std::uint64_t b) {
+  mum(a, b);
+  return a ^ b;
+}
+
+std::uint64_t read8(const std::uint8_t* p) {
+  std::uint64_t res;
+  std::memcpy(&res, p, sizeof res);
+  return res;
+}
+
+std::uint64_t read4(const std::uint8_t* p) {
+  std::uint32_t res;
+  std::memcpy(&res, p, sizeof res);
+  return res;
+}
+
+std::uint64_t read3(const std::uint8_t* p, std::size_t len) {
+  return (static_cast<std::uint64_t>(p[0]) << 16) |
+         (static_cast<std::uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+}
+}  // namespace
+
+std::uint64_t hash64(std::string_view data, std::uint64_t seed) {
+  auto p = reinterpret_cast<const std::uint8_t*>(data.data());
+  auto len = data.size();
+  std::uint64_t a, b;
+  seed ^= mix(seed ^ secret[0], secret[1]);
+
+  if (len <= 16) {
+    if (len >= 4) {
+      auto mid = (len >> 3) << 2;
+      a = (read4(p) << 32) | read4(p + mid);
+      b = (read4(p + len - 4) << 32) | read4(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = read3(p, len);
+      b = 0;
+    } else
+      a = b = 0;
+  } else {
+    auto left = len;
+    if (left > 48) {
+      auto see1 = seed, see2 = seed;
+      do {
+        seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+        see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+        see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+        p += 48;
+        left -= 48;
+      } while (left > 48);
+      seed ^= see1 ^ see2;
+    }
+
+    while (left > 16) {
+      seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+      p += 16;
+      left -= 16;
+    }
+
+    a = read8(p + left - 16);
+    b = read8(p + left - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  mum(a, b);
+  return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+}  // namespace theo::util
@@ -0,0 +1,232 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <util/parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace theo::util {
+namespace {
+// the range of indices a worker owns, [begin, end) packed into one value so
+// that the owner and thieves can update it with a single compare exchange...
+//
+struct alignas(64) range_t {
+  std::atomic<std::uint64_t> val;
+};
+
+constexpr std::uint64_t pack(std::uint64_t bgn, std::uint64_t end) {
+  return bgn << 32 | end;
+}
+
+// takes the first index of a range...
+//
+std::optional<std::size_t> take(range_t& range) {
+  auto val = range.val.load();
+  for (;;) {
+    auto bgn = val >> 32, end = val & 0xFFFFFFFF;
+    if (bgn >= end)
+      return {};
+
+    if (range.val.compare_exchange_weak(val, pack(bgn + 1, end)))
+      return bgn;
+  }
+}
+
+// moves the back half of the largest range of the other workers into an
+// empty range. returns false once every range is empty...
+//
+bool steal(std::vector<range_t>& ranges, range_t& own) {
+  for (;;) {
+    range_t* victim = nullptr;
+    std::uint64_t victim_val = {}, most = {};
+    for (auto& range : ranges) {
+      auto val = range.val.load();
+      auto left = (val & 0xFFFFFFFF) - std::min(val >> 32, val & 0xFFFFFFFF);
+      if (left > most) {
+        victim = &range;
+        victim_val = val;
+        most = left;
+      }
+    }
+
+    if (!victim)
+      return false;
+
+    auto bgn = victim_val >> 32, end = victim_val & 0xFFFFFFFF;
+    auto mid = bgn + (end - bgn) / 2;
+    if (victim->val.compare_exchange_strong(victim_val, pack(bgn, mid))) {
+      own.val.store(pack(mid, end));
+      return true;
+    }
+  }
+}
+
+// set on the threads of the pool and on a thread that is running a job on
+// it, a parallel_for from such a thread runs on that thread alone...
+//
+thread_local bool in_pool = false;
+
+// process wide pool of worker threads. threads are started the first time a
+// job needs them and are kept until the process exits. one job runs at a time,
+// each thread of the pool runs at most one worker of it...
+//
+class pool_t {
+ public:
+  static pool_t* get() {
+    static pool_t obj;
+    return &obj;
+  }
+
+  ~pool_t() {
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_stop = true;
+    }
+
+    m_cv.notify_all();
+    std::for_each(m_threads.begin(), m_threads.end(),
+                  [&](std::thread& t) { t.join(); });
+  }
+
+  // runs worker 0 on the calling thread and workers 1 to num - 1 on the pool.
+  // a worker that no thread picked up before worker 0 returns is never run,
+  // the workers steal from each other so worker 0 has done its work...
+  //
+  void run(std::size_t num, const std::function<void(std::size_t)>& worker) {
+    std::unique_lock<std::mutex> job(m_job_mtx, std::defer_lock);
+    if (in_pool || !job.try_lock()) {
+      worker(0);
+      return;
+    }
+
+    in_pool = true;
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      while (m_threads.size() < num - 1)
+        m_threads.emplace_back([this]() { loop(); });
+
+      m_worker = &worker;
+      m_num = num;
+      m_next = 1;
+      ++m_job;
+    }
+
+    m_cv.notify_all();
+    worker(0);
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_num = m_next;
+    m_done_cv.wait(lock, [&]() { return !m_busy; });
+    m_worker = nullptr;
+    in_pool = false;
+  }
+
+ private:
+  pool_t() = default;
+
+  void loop() {
+    in_pool = true;
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mtx);
+    for (;;) {
+      m_cv.wait(lock, [&]() { return m_stop || m_job != seen; });
+      if (m_stop)
+        return;
+
+      seen = m_job;
+      if (m_next >= m_num)
+        continue;
+
+      auto id = m_next++;
+      ++m_busy;
+      lock.unlock();
+      (*m_worker)(id);
+      lock.lock();
+
+      if (!--m_busy)
+        m_done_cv.notify_all();
+    }
+  }
+
+  std::mutex m_job_mtx;
+  std::mutex m_mtx;
+  std::condition_variable m_cv;
+  std::condition_variable m_done_cv;
+  std::vector<std::thread> m_threads;
+  const std::function<void(std::size_t)>* m_worker = nullptr;
+  std::size_t m_num = 0;
+  std::size_t m_next = 0;
+  std::size_t m_busy = 0;
+  std::uint64_t m_job = 0;
+  bool m_stop = false;
+};
+}  // namespace
+
+std::uint32_t hardware_threads() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void parallel_for(std::size_t count,
+                  std::uint32_t threads,
+                  const std::function<void(std::size_t)>& fn) {
+  auto num_workers = std::min<std::size_t>(threads, count);
+  if (num_workers <= 1) {
+    for (auto idx = 0u; idx < count; ++idx)
+      fn(idx);
+    return;
+  }
+
+  assert(count <= std::numeric_limits<std::uint32_t>::max());
+  std::vector<range_t> ranges(num_workers);
+  for (auto idx = 0u; idx < num_workers; ++idx)
+    ranges[idx].val.store(pack(count * idx / num_workers,
+                               count * (idx + 1) / num_workers));
+
+  const std::function<void(std::size_t)> worker = [&](std::size_t id) {
+    auto& own = ranges[id];
+    do {
+      while (auto idx = take(own))
+        fn(idx.value());
+    } while (steal(ranges, own));
+  };
+
+  // the calling thread works as well...
+  //
+  pool_t::get()->run(num_workers, worker);
+}
+}  // namespace theo::util
@@ -0,0 +1,131 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <spdlog/spdlog.h>
+#include <util/stats.hpp>
+
+#include <fstream>
+#include <map>
+
+namespace theo::util {
+namespace {
+// the names are symbol and class names but they are escaped all the same so
+// the json is always valid...
+//
+std::string escape(const std::string& str) {
+  std::string res;
+  for (auto c : str) {
+    if (c == '"' || c == '\\')
+      res.push_back('\\');
+
+    if (static_cast<std::uint8_t>(c) < 0x20)
+      res.append(fmt::format("\\u{:04x}", static_cast<int>(c)));
+    else
+      res.push_back(c);
+  }
+  return res;
+}
+
+// trace event times are in microseconds...
+//
+std::string micros(std::uint64_t ns) {
+  return fmt::format("{}.{:03}", ns / 1000, ns % 1000);
+}
+}  // namespace
+
+stats_t::stats_t() : m_epoch(std::chrono::steady_clock::now()) {}
+
+void stats_t::clear() {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  m_stats.clear();
+  m_epoch = std::chrono::steady_clock::now();
+}
+
+std::uint64_t stats_t::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - m_epoch)
+      .count();
+}
+
+void stats_t::add(stat_t stat) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  m_stats.push_back(std::move(stat));
+}
+
+const std::vector<stat_t>& stats_t::all() const {
+  return m_stats;
+}
+
+bool stats_t::write_trace(const std::filesystem::path& path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    spdlog::error("failed to open trace file: {}", path.string());
+    return false;
+  }
+
+  // every track is shown as a thread named after the first stat on it...
+  //
+  std::map<std::uint32_t, std::string> tracks;
+  for (auto& stat : m_stats)
+    tracks.try_emplace(stat.track, stat.track ? stat.name : "pipeline");
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  auto first = true;
+  for (auto& [track, name] : tracks) {
+    out << (first ? "\n" : ",\n")
+        << fmt::format(
+               "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+               "\"args\":{{\"name\":\"{}\"}}}}",
+               track, escape(name));
+    first = false;
+  }
+
+  for (auto& stat : m_stats) {
+    out << (first ? "\n" : ",\n")
+        << fmt::format(
+               "{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},"
+               "\"ts\":{},\"dur\":{},\"args\":{{\"syms_visited\":{},"
+               "\"syms_created\":{},\"bytes_added\":{},\"relocs_added\":{},"
+               "\"cpu_us\":{}}}}}",
+               escape(stat.name), stat.track, micros(stat.bgn_ns),
+               micros(stat.time_ns), stat.syms_visited, stat.syms_created,
+               stat.bytes_added, stat.relocs_added, micros(stat.cpu_ns));
+    first = false;
+  }
+
+  out << "\n]}\n";
+  if (!out) {
+    spdlog::error("failed to write trace file: {}", path.string());
+    return false;
+  }
+
+  return true;
+}
+}  // namespace theo::util
@@ -0,0 +1,64 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// counts every heap allocation made by the test. alloc_count.cpp replaces the
+// global operator new and operator delete, link it into the tests that use
+// this header...
+//
+namespace theo::tests {
+extern std::atomic<std::size_t> num_allocs;
+extern std::atomic<std::size_t> num_bytes;
+
+/// <summary>
+/// counts the allocations made while it is alive.
+/// </summary>
+class alloc_count_t {
+ public:
+  alloc_count_t() : m_allocs(num_allocs), m_bytes(num_bytes) {}
+
+  /// <summary>
+  /// the number of allocations made since this object was created.
+  /// </summary>
+  std::size_t allocs() const { return num_allocs - m_allocs; }
+
+  /// <summary>
+  /// the number of bytes allocated since this object was created.
+  /// </summary>
+  std::size_t bytes() const { return num_bytes - m_bytes; }
+
+ private:
+  std::size_t m_allocs;
+  std::size_t m_bytes;
+};
+}  // namespace theo::tests
@@ -0,0 +1,138 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <cstdint>
+#include <filesystem>
+
+#include <spdlog/spdlog.h>
+#include <theo.hpp>
+
+#include <obf/engine.hpp>
+#include <obf/passes/func_split_pass.hpp>
+#include <obf/passes/next_inst_pass.hpp>
+#include <obf/passes/reloc_transform_pass.hpp>
+#include <util/hash.hpp>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "alloc_count.hpp"
+
+namespace {
+// peak resident memory of the process in KiB...
+//
+std::size_t peak_rss() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters = {};
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize / 1024;
+#else
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+#endif
+}
+}  // namespace
+
+/// <summary>
+/// measures the heap allocations and the peak resident memory of decomposing
+/// and composing a lib with func_split_pass_t, which turns every instruction
+/// into a symbol. run it on the same lib with two builds to compare them.
+/// nothing is really mapped, allocations are handed out from a made up base
+/// address and external symbols resolve to made up addresses.
+/// </summary>
+/// <param name="argc"></param>
+/// <param name="argv">the path to the lib and the name of its entry
+/// point.</param>
+/// <returns>zero if the lib was composed.</returns>
+int main(int argc, char* argv[]) {
+  if (argc < 3)
+    return -1;
+
+  xed_tables_init();
+
+  auto engine = theo::obf::engine_t::get();
+  engine->add_pass(theo::obf::func_split_pass_t::get());
+  engine->add_pass(theo::obf::reloc_transform_pass_t::get());
+  engine->add_pass(theo::obf::next_inst_pass_t::get());
+  engine->seed(0x5EED);
+
+  std::uintptr_t next = 0x140000000;
+  theo::recomp::allocator_t allocator =
+      [&](std::uint32_t size,
+          coff::section_characteristics_t) -> std::uintptr_t {
+    auto addr = next;
+    next += (size + 0xF) & ~0xF;
+    return addr;
+  };
+
+  std::size_t num_copied = 0;
+  theo::recomp::copier_t copier = [&](std::uintptr_t, void*,
+                                      std::uint32_t size) {
+    num_copied += size;
+  };
+
+  theo::recomp::resolver_t resolver = [&](std::string sym) -> std::uintptr_t {
+    return 0x7FF000000000 | (theo::util::hash64(sym) & 0xFFFFFFF0);
+  };
+
+  theo::tests::alloc_count_t count;
+  auto base_rss = peak_rss();
+
+  theo::theo_t t(std::filesystem::path(argv[1]),
+                 {allocator, copier, resolver}, argv[2]);
+
+  auto num_syms = t.decompose();
+  if (!num_syms.has_value()) {
+    spdlog::error("failed to decompose {}...", argv[1]);
+    return 1;
+  }
+
+  auto dcmp_allocs = count.allocs();
+  auto dcmp_rss = peak_rss();
+
+  if (!t.compose()) {
+    spdlog::error("failed to compose {}...", argv[1]);
+    return 1;
+  }
+
+  spdlog::info("{} symbols used, {} bytes copied", num_syms.value(),
+               num_copied);
+  spdlog::info("decompose: {} allocations, peak rss {} KiB", dcmp_allocs,
+               dcmp_rss);
+  spdlog::info("compose:   {} allocations, peak rss {} KiB",
+               count.allocs() - dcmp_allocs, peak_rss());
+  spdlog::info("peak rss before the lib was loaded: {} KiB", base_rss);
+  return 0;
+}
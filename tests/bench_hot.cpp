@@ -0,0 +1,124 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <decomp/symbol.hpp>
+#include <recomp/symbol_table.hpp>
+
+using namespace theo;
+
+namespace {
+// runs fn a few times and returns the fastest run in nanoseconds per symbol...
+//
+template <class Fn>
+double time_per_sym(std::size_t count, Fn fn) {
+  auto best = ~std::uint64_t{};
+  for (auto run = 0u; run < 5; ++run) {
+    auto bgn = std::chrono::steady_clock::now();
+    fn();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - bgn)
+                  .count();
+    best = std::min<std::uint64_t>(best, ns);
+  }
+  return static_cast<double>(best) / count;
+}
+}  // namespace
+
+/// <summary>
+/// measures the loops recomp runs over every symbol: reading the hot fields
+/// through each symbol with for_each against streaming them out of the hot
+/// columns of symbol_table_t. the columns are kept up to date by refreshing
+/// the rows of the symbols a pass was given, so streaming them is timed on its
+/// own and together with refreshing every symbol, which is the most a run of
+/// the passes adds. the symbols look like the instruction symbols
+/// func_split_pass_t creates.
+/// </summary>
+/// <param name="argc"></param>
+/// <param name="argv">optionally the number of symbols, one million by
+/// default.</param>
+/// <returns></returns>
+int main(int argc, char* argv[]) {
+  std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 1000000;
+  static const std::uint8_t inst[] = {0x48, 0x8B, 0x05, 0, 0, 0, 0};
+
+  recomp::symbol_table_t tbl;
+  auto pool = decomp::name_pool_t::get();
+  for (auto idx = 0u; idx < count; ++idx) {
+    decomp::symbol_t sym(nullptr, pool->intern("sym@" + std::to_string(idx)),
+                         0, std::span<const std::uint8_t>(inst), nullptr,
+                         nullptr, {}, decomp::sym_type_t::instruction);
+
+    sym.allocated_at(0x10000 + idx * sizeof(inst));
+    tbl.put_symbol(std::move(sym));
+  }
+
+  // the sum is logged so the loops are not optimized away...
+  //
+  std::uintptr_t sum = {};
+  auto rows = time_per_sym(count, [&]() {
+    tbl.for_each([&](decomp::symbol_t& sym) {
+      auto bytes = sym.bytes();
+      sum += sym.type() + sym.allocated_at() + bytes.size() +
+             reinterpret_cast<std::uintptr_t>(bytes.data());
+    });
+  });
+
+  std::vector<decomp::symbol_t*> syms;
+  syms.reserve(count);
+  tbl.for_each([&](decomp::symbol_t& sym) { syms.push_back(&sym); });
+
+  auto& hot = tbl.hot();
+  const auto stream = [&]() {
+    for (auto idx = 0u; idx < hot.syms.size(); ++idx)
+      sum += hot.types[idx] + hot.allocs[idx] + hot.sizes[idx] +
+             reinterpret_cast<std::uintptr_t>(hot.data[idx]);
+  };
+
+  auto refreshed = time_per_sym(count, [&]() {
+    tbl.refresh(syms);
+    stream();
+  });
+
+  auto columns = time_per_sym(count, stream);
+
+  spdlog::info("{} symbols (checksum {:X})", count, sum);
+  spdlog::info("for_each over symbols:         {:.2f} ns per symbol", rows);
+  spdlog::info("refresh + loop over columns:   {:.2f} ns per symbol",
+               refreshed);
+  spdlog::info("loop over hot columns:         {:.2f} ns per symbol", columns);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+
+#include <decomp/decode_pool.hpp>
+#include <decomp/symbol.hpp>
+
+#include "alloc_count.hpp"
+
+using namespace theo;
+using theo::tests::alloc_count_t;
+
+namespace {
+decomp::symbol_t make_nop(const char* name) {
+  return decomp::symbol_t(nullptr, decomp::name_pool_t::get()->intern(name), 0,
+                          decomp::bytes_t{0x90}, nullptr, nullptr, {},
+                          decomp::sym_type_t::instruction);
+}
+}  // namespace
+
+TEST(decode_pool, reuses_released_slots) {
+  auto pool = decomp::decode_pool_t::get();
+  auto used = pool->size();
+
+  decomp::decode_ref_t ref;
+  auto inst = ref.acquire();
+  ASSERT_NE(inst, nullptr);
+  EXPECT_EQ(ref.acquire(), inst);
+  EXPECT_EQ(pool->size(), used + 1);
+
+  ref.reset();
+  EXPECT_EQ(ref.get(), nullptr);
+  EXPECT_EQ(pool->size(), used);
+
+  decomp::decode_ref_t other;
+  EXPECT_EQ(other.acquire(), inst);
+}
+
+TEST(decode_pool, moves_with_the_symbol) {
+  auto pool = decomp::decode_pool_t::get();
+  auto used = pool->size();
+  {
+    auto sym = make_nop("decode_pool_move");
+    ASSERT_NE(sym.decoded(), nullptr);
+    EXPECT_EQ(pool->size(), used + 1);
+
+    auto moved = std::move(sym);
+    ASSERT_NE(moved.decoded(), nullptr);
+    EXPECT_EQ(pool->size(), used + 1);
+  }
+
+  EXPECT_EQ(pool->size(), used);
+}
+
+// decoding the instruction of a symbol takes a slot of the pool, it does not
+// allocate once the pool has a free slot...
+//
+TEST(decode_pool, decode_does_not_allocate) {
+  decomp::decode_ref_t warm;
+  warm.acquire();
+  warm.reset();
+
+  auto sym = make_nop("decode_pool_allocs");
+  alloc_count_t count;
+  EXPECT_NE(sym.decoded(), nullptr);
+  EXPECT_EQ(count.allocs(), 0u);
+}
@@ -0,0 +1,144 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <theo.hpp>
+
+#include <obf/engine.hpp>
+#include <obf/passes/func_split_pass.hpp>
+#include <obf/passes/jcc_rewrite_pass.hpp>
+#include <obf/passes/next_inst_pass.hpp>
+#include <obf/passes/reloc_transform_pass.hpp>
+#include <util/hash.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+// the bytes copied to each address, and the address of the entry point...
+//
+struct output_t {
+  std::map<std::uintptr_t, std::vector<std::uint8_t>> copies;
+  std::uintptr_t entry;
+
+  bool operator==(const output_t&) const = default;
+};
+
+// decomposes and composes the lib with the given number of threads. nothing
+// is really mapped, allocations are handed out from a made up base address and
+// external symbols resolve to made up addresses derived from their names...
+//
+output_t compose(const fs::path& lib,
+                 const char* entry_sym,
+                 std::uint32_t threads) {
+  output_t res = {};
+  std::uintptr_t next = 0x140000000;
+
+  theo::recomp::allocator_t allocator =
+      [&](std::uint32_t size,
+          coff::section_characteristics_t) -> std::uintptr_t {
+    auto addr = next;
+    next += (size + 0xF) & ~0xF;
+    return addr;
+  };
+
+  theo::recomp::copier_t copier = [&](std::uintptr_t ptr, void* buff,
+                                      std::uint32_t size) {
+    auto bytes = static_cast<std::uint8_t*>(buff);
+    res.copies[ptr].assign(bytes, bytes + size);
+  };
+
+  theo::recomp::resolver_t resolver = [&](std::string sym) -> std::uintptr_t {
+    return 0x7FF000000000 | (theo::util::hash64(sym) & 0xFFFFFFF0);
+  };
+
+  theo::obf::engine_t::get()->threads(threads);
+  theo::theo_t t(lib, {allocator, copier, resolver}, entry_sym);
+  t.threads(threads);
+
+  if (!t.decompose().has_value())
+    return res;
+
+  res.entry = t.compose();
+  return res;
+}
+}  // namespace
+
+/// <summary>
+/// checks that the same lib and seed compose to the same bytes no matter how
+/// many threads are used, and from one run to the next.
+/// </summary>
+/// <param name="argc"></param>
+/// <param name="argv">the path to the lib and the name of its entry
+/// point.</param>
+/// <returns>zero if the output of every run is the same.</returns>
+int main(int argc, char* argv[]) {
+  if (argc < 3)
+    return -1;
+
+  xed_tables_init();
+
+  auto engine = theo::obf::engine_t::get();
+  engine->add_pass(theo::obf::func_split_pass_t::get());
+  engine->add_pass(theo::obf::reloc_transform_pass_t::get());
+  engine->add_pass(theo::obf::next_inst_pass_t::get());
+  engine->add_pass(theo::obf::jcc_rewrite_pass_t::get());
+  engine->seed(0x5EED);
+
+  auto threads = std::max(theo::util::hardware_threads(), 4u);
+  auto single = compose(argv[1], argv[2], 1);
+  if (!single.entry || single.copies.empty()) {
+    spdlog::error("failed to compose {}...", argv[1]);
+    return 1;
+  }
+
+  for (auto run = 0u; run < 2; ++run) {
+    if (compose(argv[1], argv[2], threads) != single) {
+      spdlog::error("run {} with {} threads differs from one thread...", run,
+                    threads);
+      return 1;
+    }
+  }
+
+  if (compose(argv[1], argv[2], 1) != single) {
+    spdlog::error("second run with one thread differs from the first...");
+    return 1;
+  }
+
+  spdlog::info("{} allocations composed the same every run...",
+               single.copies.size());
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <util/parallel.hpp>
+
+using theo::util::parallel_for;
+
+// every index is visited once, also by calls that reuse the threads of the
+// pool and by calls made from inside of the callback...
+//
+TEST(parallel, visits_every_index_once) {
+  for (auto run = 0u; run < 0x100; ++run) {
+    std::vector<std::atomic<std::uint32_t>> hits(0x400);
+    parallel_for(hits.size(), 8, [&](std::size_t idx) {
+      ++hits[idx];
+      if (!(idx % 0x100))
+        parallel_for(4, 4, [&](std::size_t) {});
+    });
+
+    for (auto& hit : hits)
+      ASSERT_EQ(hit, 1u);
+  }
+}
+
+// calls from several threads at once share the pool...
+//
+TEST(parallel, concurrent_callers) {
+  std::atomic<std::size_t> sum = 0;
+  std::vector<std::thread> callers;
+  for (auto cnt = 0u; cnt < 4; ++cnt)
+    callers.emplace_back([&]() {
+      for (auto run = 0u; run < 0x40; ++run)
+        parallel_for(100, 4, [&](std::size_t idx) { sum += idx; });
+    });
+
+  for (auto& caller : callers)
+    caller.join();
+
+  EXPECT_EQ(sum, 4u * 0x40 * 4950);
+}
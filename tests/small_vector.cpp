@@ -0,0 +1,98 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <util/small_vector.hpp>
+
+#include "alloc_count.hpp"
+
+using theo::tests::alloc_count_t;
+using theo::util::small_vector;
+
+// the longest x86 instruction fits inline...
+//
+TEST(small_vector, inline_no_alloc) {
+  alloc_count_t count;
+  small_vector<std::uint8_t, 16> bytes(15, 0xCC);
+  bytes.push_back(0x90);
+  small_vector<std::uint8_t, 16> moved(std::move(bytes));
+  EXPECT_EQ(moved.size(), 16);
+  EXPECT_EQ(count.allocs(), 0);
+}
+
+// growing past the inline elements allocates once per doubling...
+//
+TEST(small_vector, grow_allocs_once) {
+  alloc_count_t count;
+  small_vector<std::uint8_t, 16> bytes(16, 0xCC);
+  bytes.push_back(0x90);
+  EXPECT_EQ(count.allocs(), 1);
+
+  // moving a heap buffer steals it...
+  //
+  small_vector<std::uint8_t, 16> moved(std::move(bytes));
+  EXPECT_EQ(count.allocs(), 1);
+  EXPECT_EQ(moved.size(), 17);
+  EXPECT_TRUE(bytes.empty());
+}
+
+// inserting a range of the vector into itself while it grows...
+//
+TEST(small_vector, insert_self_range) {
+  small_vector<std::string, 2> strs = {"a", "b"};
+  strs.insert(strs.begin() + 1, strs.begin(), strs.end());
+  ASSERT_EQ(strs.size(), 4);
+  EXPECT_EQ(strs[0], "a");
+  EXPECT_EQ(strs[1], "a");
+  EXPECT_EQ(strs[2], "b");
+  EXPECT_EQ(strs[3], "b");
+}
+
+// resizing with an element of the vector while it grows...
+//
+TEST(small_vector, resize_with_self) {
+  small_vector<std::string, 2> strs = {"a", "b"};
+  strs.resize(5, strs[1]);
+  ASSERT_EQ(strs.size(), 5);
+  EXPECT_EQ(strs[2], "b");
+  EXPECT_EQ(strs[4], "b");
+}
+
+// pushing an element of the vector while it grows...
+//
+TEST(small_vector, push_back_self) {
+  small_vector<std::string, 2> strs = {"a", "b"};
+  strs.push_back(strs[0]);
+  ASSERT_EQ(strs.size(), 3);
+  EXPECT_EQ(strs[2], "a");
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <decomp/symbol.hpp>
+
+#include "alloc_count.hpp"
+
+using namespace theo;
+using theo::tests::alloc_count_t;
+
+// creating an instruction symbol the way func_split_pass_t does makes no heap
+// allocation of its own...
+//
+TEST(symbol_allocs, instruction_no_alloc) {
+  static const std::uint8_t fn[] = {
+      0x48, 0x8B, 0x05, 0x00, 0x00, 0x00, 0x00,  // mov rax, [rip+...]
+      0xC3                                        // ret
+  };
+
+  // names are interned before counting, func_split interns them too but the
+  // pool is not part of the symbol...
+  //
+  auto pool = decomp::name_pool_t::get();
+  auto inst_name = pool->intern("fn");
+  auto data_name = pool->intern("data");
+  auto next_name = pool->intern("fn@7");
+
+  std::vector<decomp::symbol_t> result;
+  result.reserve(1);
+
+  alloc_count_t count;
+  decomp::relocs_t relocs;
+  relocs.push_back(recomp::reloc_t(3, data_name));
+  relocs.push_back(recomp::reloc_t(0, next_name));
+
+  decomp::bytes_t inst_bytes(fn, fn + 7);
+  auto& inst_sym = result.emplace_back(
+      nullptr, inst_name, 0, std::move(inst_bytes), nullptr, nullptr,
+      std::move(relocs), decomp::sym_type_t::instruction);
+
+  EXPECT_EQ(count.allocs(), 0);
+  EXPECT_EQ(inst_sym.bytes().size(), 7);
+  EXPECT_EQ(inst_sym.relocs().size(), 2);
+}
+
+// the longest x86 instruction still fits...
+//
+TEST(symbol_allocs, longest_instruction_no_alloc) {
+  auto inst_name = decomp::name_pool_t::get()->intern("fn");
+
+  alloc_count_t count;
+  decomp::bytes_t long_inst(15, 0x90);
+  decomp::symbol_t long_sym(nullptr, inst_name, 0, std::move(long_inst));
+  EXPECT_EQ(count.allocs(), 0);
+}
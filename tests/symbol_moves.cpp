@@ -0,0 +1,118 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <decomp/symbol.hpp>
+#include <recomp/symbol_table.hpp>
+
+#include "alloc_count.hpp"
+
+using namespace theo;
+using theo::tests::alloc_count_t;
+
+// symbols are moved into the symbol table and never copied. a symbol is moved
+// if the table ends up with the same byte buffer and no buffer the size of the
+// bytes was allocated...
+//
+namespace {
+// large enough that a copy of the bytes of a symbol cannot hide among the
+// allocations the symbol table makes for itself...
+//
+constexpr std::size_t data_size = 0x100000;
+
+decomp::symbol_t make_sym(const char* name) {
+  return decomp::symbol_t(nullptr, decomp::name_pool_t::get()->intern(name), 0,
+                          decomp::bytes_t(data_size, 0xCC), nullptr, nullptr,
+                          {}, decomp::sym_type_t::data);
+}
+
+const std::uint8_t* data_of(recomp::symbol_table_t& tbl, const char* name) {
+  auto sym = tbl.sym_from_hash(decomp::symbol_t::hash(name));
+  return sym.has_value() ? sym.value()->bytes().data() : nullptr;
+}
+}  // namespace
+
+TEST(symbol_moves, vector_ctor) {
+  std::vector<decomp::symbol_t> syms;
+  syms.push_back(make_sym("ctor"));
+  auto data = syms.back().bytes().data();
+
+  alloc_count_t count;
+  recomp::symbol_table_t tbl(std::move(syms));
+  EXPECT_LT(count.bytes(), data_size);
+  EXPECT_EQ(data_of(tbl, "ctor"), data);
+}
+
+TEST(symbol_moves, put_symbol) {
+  recomp::symbol_table_t tbl;
+  tbl.put_symbol(make_sym("warm"));
+
+  auto sym = make_sym("put_symbol");
+  auto data = sym.bytes().data();
+  alloc_count_t count;
+  auto res = tbl.put_symbol(std::move(sym));
+  EXPECT_LT(count.bytes(), data_size);
+  ASSERT_NE(res, nullptr);
+  EXPECT_EQ(res->bytes().data(), data);
+}
+
+TEST(symbol_moves, put_symbols) {
+  recomp::symbol_table_t tbl;
+  tbl.put_symbol(make_sym("warm"));
+
+  std::vector<decomp::symbol_t> syms;
+  syms.push_back(make_sym("put_symbols"));
+  auto data = syms.back().bytes().data();
+  alloc_count_t count;
+  EXPECT_TRUE(tbl.put_symbols(std::move(syms)));
+  EXPECT_LT(count.bytes(), data_size);
+  EXPECT_EQ(data_of(tbl, "put_symbols"), data);
+}
+
+// replace, the way func_split_pass_t replaces a function...
+//
+TEST(symbol_moves, replace) {
+  recomp::symbol_table_t tbl;
+  tbl.put_symbol(make_sym("replace"));
+
+  auto sym = make_sym("replace");
+  auto data = sym.bytes().data();
+  alloc_count_t count;
+  auto res = tbl.replace(std::move(sym));
+  EXPECT_LT(count.bytes(), data_size);
+  ASSERT_NE(res, nullptr);
+  EXPECT_EQ(res->bytes().data(), data);
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2022, _xeroxz
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <decomp/symbol.hpp>
+#include <recomp/symbol_table.hpp>
+
+using namespace theo;
+
+// symbols keep their address and stay reachable as the arena grows past
+// several segments...
+//
+TEST(symbol_table, arena_segments) {
+  static const std::uint8_t inst[] = {0x90};
+  constexpr std::size_t count = 0x2000;
+
+  recomp::symbol_table_t tbl;
+  auto pool = decomp::name_pool_t::get();
+  std::vector<decomp::symbol_t*> syms;
+  for (auto idx = 0u; idx < count; ++idx) {
+    auto name = pool->intern("arena@" + std::to_string(idx));
+    syms.push_back(tbl.put_symbol(
+        decomp::symbol_t(nullptr, name, 0, std::span<const std::uint8_t>(inst),
+                         nullptr, nullptr, {},
+                         decomp::sym_type_t::instruction)));
+    ASSERT_NE(syms.back(), nullptr);
+  }
+
+  auto& hot = tbl.hot();
+  ASSERT_EQ(hot.syms.size(), count);
+  for (auto idx = 0u; idx < count; ++idx) {
+    auto row = tbl.row_of(syms[idx]->hash());
+    ASSERT_TRUE(row.has_value());
+    EXPECT_EQ(row.value(), idx);
+    EXPECT_EQ(hot.syms[idx], syms[idx]);
+  }
+
+  // refreshing finds the row of a symbol from its address...
+  //
+  for (auto idx = 0u; idx < count; idx += 3)
+    syms[idx]->allocated_at(0x1000 + idx);
+
+  tbl.refresh(syms);
+  for (auto idx = 0u; idx < count; ++idx)
+    EXPECT_EQ(hot.allocs[idx], idx % 3 ? 0 : 0x1000 + idx);
+}
+
+// the transformation chains of a symbol go back to the pool when it leaves the
+// table and are reused, so the pool does not grow across rebuilds...
+//
+TEST(symbol_table, erase_releases_transforms) {
+  static const std::uint8_t inst[] = {0x90};
+  const recomp::transform_entry_t chain[] = {{nullptr, 1}, {nullptr, 2}};
+
+  auto pool = decomp::name_pool_t::get();
+  auto transforms = recomp::transform_pool_t::get();
+  auto name = pool->intern("transforms");
+  auto used = transforms->size();
+
+  recomp::symbol_table_t tbl;
+  for (auto run = 0u; run < 4; ++run) {
+    decomp::relocs_t relocs;
+    relocs.push_back(recomp::reloc_t(0, name));
+    relocs.back().set_transforms(chain);
+
+    ASSERT_NE(tbl.put_symbol(decomp::symbol_t(
+                  nullptr, name, 0, std::span<const std::uint8_t>(inst),
+                  nullptr, nullptr, std::move(relocs),
+                  decomp::sym_type_t::instruction)),
+              nullptr);
+
+    EXPECT_EQ(transforms->size(), used + 2);
+    ASSERT_TRUE(tbl.erase(pool->hash(name)));
+    EXPECT_EQ(transforms->size(), used);
+  }
+}